@@ -0,0 +1,328 @@
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include <random>
+#include <array>
+#include <memory>
+#include <sstream>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "curves.h"
+#include "parsing.h"
+#include "primitives.h"
+
+using glm::vec3, glm::vec2;
+
+using std::vector, std::string, std::array;
+using std::cerr, std::endl;
+
+/*! @defgroup bench Benchmarks
+ * @{
+ * Microbenchmarks of the generator, curve and parser hot paths, written to
+ * stdout as JSON so they can be tracked over time:
+ * @code{.unparsed}
+ * {"threads": 0, "benchmarks": [
+ *   {"name": "sphere 1 64 64", "iterations": 112, "ns_per_op": 8.9e6, "vertices_per_sec": 2.7e6, "peak_rss_kib": 6144},
+ *   ...]}
+ * @endcode
+ * Every benchmark runs in its own process, so peak_rss_kib is its own.
+ */
+
+//! Wall time each benchmark is repeated for, at least once (see `--min-time`).
+static double globalMinSeconds = 0.5;
+
+//! Only benchmarks whose name contains it are run (see `--filter`).
+static string globalFilter;
+
+//! Directory for the synthetic inputs, removed on exit.
+static std::filesystem::path globalScratch;
+
+struct benchmark {
+  string name;
+  //! what one call of run counts as, e.g. one model or one curve evaluation
+  size_t ops_per_run;
+  //! returns the vertices it produced, 0 when it produces none
+  std::function<size_t ()> run;
+};
+
+/*!
+ * Runs a benchmark in a child process until globalMinSeconds have passed, and
+ * prints its JSON object.
+ */
+void bench_run (const benchmark &b, const bool first)
+{
+  fflush (stdout);
+  const pid_t pid = fork ();
+  if (pid < 0)
+    {
+      cerr << "[bench] fork failed" << endl;
+      exit (EXIT_FAILURE);
+    }
+  if (pid == 0)
+    {
+      // silence the [generator] and [parsing] logs of the code under test
+      if (!freopen ("/dev/null", "w", stderr))
+        exit (EXIT_FAILURE);
+
+      using clock = std::chrono::steady_clock;
+      size_t iterations = 0, vertices = 0;
+      const auto start = clock::now ();
+      double seconds;
+      do
+        {
+          vertices += b.run ();
+          ++iterations;
+          seconds = std::chrono::duration<double> (clock::now () - start).count ();
+        }
+      while (seconds < globalMinSeconds);
+
+      rusage usage{};
+      getrusage (RUSAGE_SELF, &usage);
+      const double ops = (double) iterations * (double) b.ops_per_run;
+      printf ("%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.6g, "
+              "\"vertices_per_sec\": %.6g, \"peak_rss_kib\": %ld}",
+              first ? "" : ",", b.name.c_str (), iterations, seconds * 1e9 / ops,
+              (double) vertices / seconds, usage.ru_maxrss);
+      fflush (stdout);
+      _exit (EXIT_SUCCESS);
+    }
+
+  int status;
+  waitpid (pid, &status, 0);
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != EXIT_SUCCESS)
+    {
+      cerr << "[bench] " << b.name << " failed" << endl;
+      exit (EXIT_FAILURE);
+    }
+}
+
+/*!
+ * A benchmark of generate_model on a ⟨model⟩ without its ⟨out_file⟩, one op
+ * per model. Names default to the ⟨model⟩, input files should not be part of them.
+ */
+benchmark bench_model (const string &model, const string &name = "")
+{
+  auto words = std::make_shared<vector<string>> (vector<string>{"generator"});
+  std::istringstream model_words (model);
+  for (string word; model_words >> word;)
+    words->push_back (word);
+  auto argv = std::make_shared<vector<const char *>> ();
+  for (const auto &word : *words)
+    argv->push_back (word.c_str ());
+
+  return {name.empty () ? model : name, 1, [words, argv] () {
+    model_vector<vec3> vertices, normals;
+    model_vector<vec2> texture;
+    generate_model ((int) argv->size (), argv->data (), vertices, normals, texture);
+    return vertices.size ();
+  }};
+}
+
+/*!
+ * Writes a patch file (see read_Bezier) of a grid of nPatches flat patches,
+ * sharing their edge control points like the teapot's do.
+ */
+string bench_write_patch_file (const int nPatches)
+{
+  const int side = 3 * nPatches + 1;
+  const auto path = globalScratch / ("grid_" + std::to_string (nPatches) + ".patch");
+  std::ofstream patch (path);
+  patch << nPatches << "\n";
+  for (int p = 0; p < nPatches; ++p)
+    for (int i = 0; i < 16; ++i)
+      patch << (i / 4) * side + 3 * p + i % 4 << (i < 15 ? ", " : "\n");
+  patch << 4 * side << "\n";
+  for (int row = 0; row < 4; ++row)
+    for (int column = 0; column < side; ++column)
+      patch << (float) column / 3 << ", " << (float) row / 3 << ", " << 0.1f * (float) ((row + column) % 4) << "\n";
+  return path.string ();
+}
+
+/*!
+ * Writes a scene of nGroups groups nested two deep, each with a timed translation
+ * along a curve, a rotation, a scale and a colored model.
+ */
+string bench_write_scene (const int nGroups)
+{
+  const auto model_path = globalScratch / "scene_model.3d";
+  if (!std::filesystem::exists (model_path))
+    std::ofstream (model_path) << "";
+
+  const auto path = globalScratch / ("scene_" + std::to_string (nGroups) + ".xml");
+  std::ofstream scene (path);
+  scene << "<world>\n"
+           "  <camera><position x=\"0\" y=\"0\" z=\"100\"/><lookAt x=\"0\" y=\"0\" z=\"0\"/></camera>\n"
+           "  <lights><light type=\"point\" posX=\"0\" posY=\"0\" posZ=\"0\"/></lights>\n"
+           "  <group>\n";
+  for (int g = 0; g < nGroups; ++g)
+    scene << "    <group>\n"
+             "      <transform>\n"
+             "        <translate time=\"" << 10 + g % 7 << "\" align=\"true\">\n"
+             "          <point x=\"" << g << "\" y=\"0\" z=\"0\"/><point x=\"0\" y=\"" << g << "\" z=\"0\"/>\n"
+             "          <point x=\"-" << g << "\" y=\"0\" z=\"0\"/><point x=\"0\" y=\"-" << g << "\" z=\"0\"/>\n"
+             "        </translate>\n"
+             "        <rotate time=\"" << 5 + g % 3 << "\" x=\"0\" y=\"1\" z=\"0\"/>\n"
+             "        <scale x=\"0.5\" y=\"0.5\" z=\"0.5\"/>\n"
+             "      </transform>\n"
+             "      <models>\n"
+             "        <model file=\"" << model_path.string () << "\">\n"
+             "          <color><diffuse R=\"200\" G=\"100\" B=\"50\"/><shininess value=\"64\"/></color>\n"
+             "        </model>\n"
+             "      </models>\n"
+             "      <group><transform><translate x=\"1\" y=\"0\" z=\"0\"/></transform>\n"
+             "        <models><model file=\"" << model_path.string () << "\"/></models>\n"
+             "      </group>\n"
+             "    </group>\n";
+  scene << "  </group>\n"
+           "</world>\n";
+  return path.string ();
+}
+
+/*!
+ * ⟨command⟩ ::= "bench" ⟨option⟩⃰
+ * ⟨option⟩ ::= "--threads" ⟨number_of_threads⟩ | "--min-time" ⟨seconds⟩ | "--filter" ⟨substring⟩
+ */
+int main (int argc, const char *const argv[])
+{
+  for (int a = 1; a < argc; a += 2)
+    {
+      if (a + 1 >= argc)
+        {
+          cerr << "[bench] missing value for " << argv[a] << endl;
+          exit (EXIT_FAILURE);
+        }
+      if (!strcmp (argv[a], "--threads"))
+        {
+          int threads;
+          if (!model_int_argument (argv[a + 1], threads) || threads < 0)
+            {
+              cerr << "[bench] invalid number of threads(" << argv[a + 1] << ")" << endl;
+              exit (EXIT_FAILURE);
+            }
+          globalThreads = threads;
+        }
+      else if (!strcmp (argv[a], "--min-time"))
+        {
+          char *end;
+          globalMinSeconds = strtod (argv[a + 1], &end);
+          if (end == argv[a + 1] || !(globalMinSeconds >= 0))
+            {
+              cerr << "[bench] invalid minimum time(" << argv[a + 1] << ")" << endl;
+              exit (EXIT_FAILURE);
+            }
+        }
+      else if (!strcmp (argv[a], "--filter"))
+        globalFilter = argv[a + 1];
+      else
+        {
+          cerr << "[bench] Unknown option: " << argv[a] << endl;
+          exit (EXIT_FAILURE);
+        }
+    }
+
+  globalScratch = std::filesystem::temp_directory_path () / ("bench_" + std::to_string (getpid ()));
+  std::filesystem::create_directories (globalScratch);
+
+  vector<benchmark> benchmarks;
+  for (const int divisions : {16, 128, 512})
+    {
+      const auto d = std::to_string (divisions);
+      benchmarks.push_back (bench_model ("plane 2 " + d));
+      benchmarks.push_back (bench_model ("box 2 " + d));
+      benchmarks.push_back (bench_model ("sphere 1 " + d + " " + d));
+      benchmarks.push_back (bench_model ("cone 1 2 " + d + " " + d));
+      benchmarks.push_back (bench_model ("cubesphere 1 " + d));
+    }
+  for (const int subdivisions : {2, 5, 7})
+    benchmarks.push_back (bench_model ("icosphere 1 " + std::to_string (subdivisions)));
+  const string grid = bench_write_patch_file (32);
+  for (const int tesselation : {4, 16, 64})
+    benchmarks.push_back (bench_model ("bezier " + grid + " " + std::to_string (tesselation),
+                                       "bezier grid_32 " + std::to_string (tesselation)));
+  for (const string error : {"0.01", "0.001"})
+    benchmarks.push_back (bench_model ("bezier-adaptive " + grid + " " + error, "bezier-adaptive grid_32 " + error));
+
+  // curve evaluation throughput, one op per point
+  {
+    const size_t nPoints = 1 << 16;
+    auto ts = std::make_shared<vector<float>> (nPoints);
+    auto curves = std::make_shared<vector<array<vec3, 4>>> (nPoints);
+    std::mt19937 random (42);
+    std::uniform_real_distribution<float> uniform (0, 1);
+    for (size_t i = 0; i < nPoints; ++i)
+      {
+        (*ts)[i] = uniform (random);
+        for (auto &point : (*curves)[i])
+          point = vec3 (uniform (random), uniform (random), uniform (random));
+      }
+    for (const auto &[name, M] : {std::pair{"get_curve_point_at catmull-rom", &Mcr},
+                                  std::pair{"get_curve_point_at bezier", &Mb}})
+      benchmarks.push_back ({name, nPoints, [ts, curves, M = M] () {
+        vec3 sum (0), position, derivative;
+        for (size_t i = 0; i < ts->size (); ++i)
+          {
+            get_curve_point_at ((*ts)[i], *M, (*curves)[i], position, derivative);
+            sum += position + derivative;
+          }
+        // keep the evaluations from being optimized away
+        if (sum.x == 1234.5f)
+          cerr << sum.x << endl;
+        return ts->size ();
+      }});
+  }
+
+  // patch parsing, text and binary, one op per patch
+  for (const int nPatches : {1000, 20000})
+    {
+      const string patch = bench_write_patch_file (nPatches);
+      const string binary_patch = patch + ".bin";
+      patch_convert (patch.c_str (), binary_patch.c_str ());
+      for (const auto &[format, path] : {std::pair{" text", patch}, std::pair{" binary", binary_patch}})
+        benchmarks.push_back ({"read_Bezier " + std::to_string (nPatches) + " patches" + format, (size_t) nPatches,
+                               [path = path] () {
+                                 read_Bezier (path.c_str ());
+                                 return (size_t) 0;
+                               }});
+    }
+
+  // scene parsing, one op per group
+  for (const int nGroups : {100, 5000})
+    {
+      const string scene = bench_write_scene (nGroups);
+      benchmarks.push_back ({"operations_load_xml " + std::to_string (nGroups) + " groups", (size_t) nGroups,
+                             [scene] () {
+                               vector<float> operations;
+                               operations_load_xml (scene, operations);
+                               return (size_t) 0;
+                             }});
+    }
+
+  printf ("{\"threads\": %u, \"min_time\": %g, \"benchmarks\": [", globalThreads, globalMinSeconds);
+  bool first = true;
+  for (const auto &b : benchmarks)
+    if (b.name.find (globalFilter) != string::npos)
+      {
+        cerr << "[bench] " << b.name << endl;
+        bench_run (b, first);
+        first = false;
+      }
+  printf ("\n]}\n");
+
+  std::filesystem::remove_all (globalScratch);
+  return 0;
+}
+
+//! @} end of group bench
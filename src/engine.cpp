@@ -11,11 +11,27 @@
 #endif
 
 #include <cstdio>
+#include <cstring>
+#include <cstddef>
 #include <cmath>
 #include <iostream>
 #include <vector>
 #include <tuple>
 #include <map>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <filesystem>
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <IL/il.h>
 #include <glm/glm.hpp>
@@ -24,9 +40,13 @@
 
 #include "parsing.h"
 #include "curves.h"
+#include "model.h"
+#include "pack.h"
+#include "primitives.h"
+#include "texture_cache.h"
 
 using std::vector, std::tuple, std::map;
-using glm::mat4, glm::vec4, glm::vec3, glm::cross, glm::value_ptr;
+using glm::mat4, glm::vec4, glm::vec3, glm::vec2, glm::cross, glm::value_ptr;
 using std::cerr, std::endl, glm::to_string, std::string;
 
 /*rotation*/
@@ -874,8 +894,17 @@ void changeProfile ()
 const auto RGB_MAX = 255.0;
 struct model {
   GLsizei nVertices{};
+  //! positions, normals and texture coordinates
   GLuint vbo{};
-  GLuint normals{};
+  //! vertices and indices read by a loader thread, still to be copied to vbo and ibo (see uploadPendingBuffers)
+  const void *pendingVertices = nullptr;
+  GLsizeiptr pendingVerticesSize = 0;
+  const void *pendingIndices = nullptr;
+  //! with pendingVertices, streams pending apart from each other, interleaved as they are uploaded (see setPendingStreams)
+  const void *pendingNormals = nullptr;
+  const void *pendingTexCoords = nullptr;
+  //! assets of the model still loading, it is not drawn until they are all uploaded
+  int loading = 0;
   struct {
     // default values specified at (page 5)[Phase 4 – Normals and Texture Coordinates][Practical Assignment CG - 2021/22 pdf]
     vec4 diffuse{200.0 / RGB_MAX, 200.0 / RGB_MAX, 200.0 / RGB_MAX, 1};
@@ -886,88 +915,745 @@ struct model {
   } material{};
   // 0 default value means it's optional with 0 meaning it's not being used by a particular model.
   GLuint tbo = 0; // texture buffer object
-  GLuint tc = 0; // texture coordinates
+  // only set for indexed models, legacy models are drawn with glDrawArrays
+  GLuint ibo = 0; // index buffer object
+  GLsizei nIndices = 0;
+  GLenum indexType = 0;
+  //! layout of the vertex streams, always interleaved once uploaded (see setPendingStreams),
+  //! narrower than GL_FLOAT in quantized models
+  GLenum vertexType = GL_FLOAT;
+  GLsizei vertexStride = 8 * sizeof (GLfloat);
+  GLenum normalType = GL_FLOAT;
+  GLsizei normalStride = 8 * sizeof (GLfloat);
+  GLintptr normalOffset = 3 * sizeof (GLfloat);
+  GLenum texCoordType = GL_FLOAT;
+  GLsizei texCoordStride = 8 * sizeof (GLfloat);
+  GLintptr texCoordOffset = 6 * sizeof (GLfloat);
+  //! dequantization of positions and texture coordinates, `value = offset + scale * quantized`
+  vec3 positionOffset{0};
+  float positionScale = 1;
+  vec2 textureOffset{0};
+  vec2 textureScale{1};
+  //! bounding box and sphere of the positions, from the file's header or its bounds cache
+  vec3 aabbMin{0};
+  vec3 aabbMax{0};
+  vec3 center{0};
+  float radius = 0;
+  //! coarser levels of detail, each with about a quarter of the triangles of the previous one
+  vector<struct model> lods;
+  //! index ranges culled on their own, empty when the model is drawn whole
+  vector<model_cluster> clusters;
+  //! never seen from inside (`closed="true"`), so its back facing clusters are culled (see cullClusters)
+  bool closed = false;
 };
 
+//! Projected diameter, in pixels, below which models are drawn at a coarser level of detail.
+const float DEFAULT_LOD_PIXELS = 256;
+static float globalLodPixels = DEFAULT_LOD_PIXELS;
+
 static std::vector<struct model> globalModels;
 static std::vector<float> globalOperations;
 
-struct model allocModel (const char *const model3dFilePath)
+struct mappedModelFile;
+void setPendingIndices (struct model &model, GLsizei nIndices, unsigned int indexSize, const void *arrayOfIndices);
+struct model readModel (mappedModelFile &file, GLsizei nVertices, GLsizei nIndices, unsigned int indexSize,
+                        bool interleaved = false, model_bounds *bounds = nullptr);
+struct model readQuantizedModel (mappedModelFile &file, const model_quantized_header &header,
+                                 model_bounds *bounds = nullptr);
+struct model readSectionedModel (mappedModelFile &file, const model_sections_header &header,
+                                 model_bounds *bounds = nullptr);
+
+//! Thrown by loadFailed on a loader thread.
+struct assetLoadFailure {};
+
+//! Set on loader threads (see @ref assetLoading).
+static thread_local bool globalIsLoader = false;
+
+/*!
+ * Gives up loading an asset, once the reason is reported. The main thread
+ * exits, a loader thread hands the load back as failed instead, for the main
+ * thread to exit from outside OpenGL (see uploadLoadedAssets).
+ */
+[[noreturn]] static void loadFailed ()
+{
+  if (globalIsLoader)
+    throw assetLoadFailure ();
+  exit (EXIT_FAILURE);
+}
+
+//! A model file mapped read only, read front to back from its cursor.
+struct mappedModelFile {
+  const char *path;
+  const char *data;
+  size_t size;
+  size_t cursor;
+  //! false for a model in a scene pack, mapped in place within the pack's mapping
+  bool ownsMapping;
+};
+
+//! Maps a whole model file, failing (see loadFailed) if it can not be opened.
+static mappedModelFile mapModelFile (const char *const model3dFilePath)
 {
-  FILE *fp = fopen (model3dFilePath, "r");
-  if (!fp)
+  const int fd = open (model3dFilePath, O_RDONLY);
+  struct stat fileStat{};
+  if (fd < 0 || fstat (fd, &fileStat))
     {
-      cerr << "failed to open model: " << model3dFilePath << endl;
-      exit (EXIT_FAILURE);
+      cerr << "failed to open: " << model3dFilePath << endl;
+      loadFailed ();
+    }
+  mappedModelFile file{model3dFilePath, nullptr, (size_t) fileStat.st_size, 0, true};
+  // empty files can not be mapped, they are only too short to hold a model
+  if (file.size)
+    {
+      void *const data = mmap (nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED)
+        {
+          cerr << "[engine] failed to map " << model3dFilePath << endl;
+          loadFailed ();
+        }
+      file.data = (const char *) data;
+    }
+  close (fd);
+  return file;
+}
+
+static void unmapModelFile (const mappedModelFile &file)
+{
+  if (file.ownsMapping && file.data)
+    munmap ((void *) file.data, file.size);
+}
+
+//! The next size bytes of a mapped file, failing (see loadFailed) if it is too short.
+static const char *takeBytes (mappedModelFile &file, const size_t size, const char *const what)
+{
+  if (size > file.size - file.cursor)
+    {
+      cerr << "[allocModel] truncated " << what << " in " << file.path << endl;
+      loadFailed ();
+    }
+  const char *const bytes = file.data + file.cursor;
+  file.cursor += size;
+  return bytes;
+}
+
+//! Copies the next bytes of a mapped file to value, headers need not be aligned in the file.
+template<typename T>
+static void takeValue (mappedModelFile &file, T &value, const char *const what)
+{
+  memcpy (&value, takeBytes (file, sizeof (value), what), sizeof (value));
+}
+
+//! Copies an array to a new buffer object.
+static GLuint uploadBuffer (const GLsizeiptr size, const void *const data)
+{
+  GLuint buffer;
+  glGenBuffers (1, &buffer);
+  glBindBuffer (GL_ARRAY_BUFFER, buffer);
+  glBufferData (GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+  glBindBuffer (GL_ARRAY_BUFFER, 0);
+  return buffer;
+}
+
+/*!
+ * Sets the streams of a model's nVertices vertices, each one an array of
+ * elements of the given size, to be interleaved as they are copied to its
+ * buffer object (see uploadInterleaved), and lays the model out interleaved.
+ */
+static void setPendingStreams (struct model &model,
+                               const void *const positions, const size_t positionSize,
+                               const void *const normals, const size_t normalSize,
+                               const void *const texCoords, const size_t texCoordSize)
+{
+  const size_t stride = positionSize + normalSize + texCoordSize;
+  model.vertexStride = model.normalStride = model.texCoordStride = (GLsizei) stride;
+  model.normalOffset = (GLintptr) positionSize;
+  model.texCoordOffset = (GLintptr) (positionSize + normalSize);
+  model.pendingVertices = positions;
+  model.pendingVerticesSize = (GLsizeiptr) (stride * model.nVertices);
+  model.pendingNormals = normals;
+  model.pendingTexCoords = texCoords;
+}
+
+//! Sets the bounding box and sphere of a model.
+static void setBounds (struct model &model, const model_bounds &bounds)
+{
+  model.aabbMin = glm::make_vec3 (bounds.min);
+  model.aabbMax = glm::make_vec3 (bounds.max);
+  model.center = glm::make_vec3 (bounds.center);
+  model.radius = bounds.radius;
+}
+
+//! Bounds of a model's quantized positions, 4 shorts each, dequantized one at a time.
+static model_bounds dequantizedBounds (const struct model &model, const GLshort *const positions)
+{
+  const auto position = [&] (const size_t v) {
+    const GLshort *const q = positions + 4 * v;
+    return model.positionOffset + model.positionScale * vec3 (q[0], q[1], q[2]);
+  };
+  model_bounds bounds{};
+  if (model.nVertices == 0)
+    return bounds;
+  vec3 lo = position (0), hi = lo;
+  for (GLsizei v = 1; v < model.nVertices; ++v)
+    {
+      lo = glm::min (lo, position (v));
+      hi = glm::max (hi, position (v));
     }
+  const vec3 center = (lo + hi) * 0.5f;
+  for (GLsizei v = 0; v < model.nVertices; ++v)
+    bounds.radius = std::max (bounds.radius, glm::distance (center, position (v)));
+  for (int axis = 0; axis < 3; ++axis)
+    {
+      bounds.min[axis] = lo[axis];
+      bounds.max[axis] = hi[axis];
+      bounds.center[axis] = center[axis];
+    }
+  return bounds;
+}
+
+/*!
+ * Copies a model's clusters, failing (see loadFailed) if any of them reaches past its indices.
+ */
+static void copyClusters (struct model &model, const char *const clusters, const size_t nClusters,
+                          const char *const model3dFilePath)
+{
+  model.clusters.resize (nClusters);
+  memcpy (model.clusters.data (), clusters, sizeof (model_cluster) * nClusters);
+  for (const auto &cluster : model.clusters)
+    if ((uint64_t) cluster.firstIndex + cluster.nIndices > (uint64_t) model.nIndices)
+      {
+        cerr << "[allocModel] cluster out of range in " << model3dFilePath << endl;
+        loadFailed ();
+      }
+}
+
+//! The model_bounds_cache of a model file, named after it.
+static string boundsCachePath (const char *const model3dFilePath)
+{
+  return string (model3dFilePath) + ".bounds";
+}
+
+/*!
+ * Reads the bounds of a model file from its model_bounds_cache, false if there
+ * is none or the file changed since it was written.
+ */
+static bool readBoundsCache (const char *const model3dFilePath, model_bounds &bounds)
+{
+  struct stat modelStat{};
+  if (stat (model3dFilePath, &modelStat))
+    return false;
+  FILE *fp = fopen (boundsCachePath (model3dFilePath).c_str (), "r");
+  if (!fp)
+    return false;
+  model_bounds_cache cache{};
+  const bool read = fread (&cache, sizeof (cache), 1, fp) == 1;
+  fclose (fp);
+  if (!read || cache.magic != MODEL_BOUNDS_MAGIC || cache.version != MODEL_BOUNDS_VERSION
+      || cache.modelSize != (int64_t) modelStat.st_size || cache.modelTime != (int64_t) modelStat.st_mtime)
+    return false;
+  bounds = cache.bounds;
+  return true;
+}
+
+//! Saves the bounds computed for a model file next to it, so later loads skip computing them.
+static void writeBoundsCache (const char *const model3dFilePath, const model_bounds &bounds)
+{
+  struct stat modelStat{};
+  if (stat (model3dFilePath, &modelStat))
+    return;
+  model_bounds_cache cache{};
+  cache.magic = MODEL_BOUNDS_MAGIC;
+  cache.version = MODEL_BOUNDS_VERSION;
+  cache.modelSize = (int64_t) modelStat.st_size;
+  cache.modelTime = (int64_t) modelStat.st_mtime;
+  cache.bounds = bounds;
+
+  const string cachePath = boundsCachePath (model3dFilePath);
+  FILE *fp = fopen (cachePath.c_str (), "w");
+  if (!fp || fwrite (&cache, sizeof (cache), 1, fp) != 1)
+    cerr << "[allocModel] failed to cache bounds in " << cachePath << endl;
+  if (fp)
+    fclose (fp);
+}
+
+/*!
+ * Reads a mapped model file (see @ref modelFormat), its buffers pending on the
+ * mapping. Its bounds are read from the header or, failing that, from its
+ * bounds cache, otherwise they are computed from the mapped positions, and
+ * computed is set.
+ */
+static struct model readModelFile (mappedModelFile &file, model_bounds &bounds, bool &computed)
+{
+  const char *const model3dFilePath = file.path;
 
   cerr << "[allocModel] model file = " << model3dFilePath << endl;
-  // read number of vertices
+  // read number of vertices, or the magic number of an indexed model
   GLsizei nVertices;
-  fread (&nVertices, sizeof (nVertices), 1, fp);
-  cerr << "[allocModel] nVertices = " << nVertices << endl;
+  takeValue (file, nVertices, "header");
 
-  // read vertices
-  auto *arrayOfVertices = (float *) malloc (3 * nVertices * sizeof (float));
-  const size_t nVerticesRead = fread (arrayOfVertices, 3 * sizeof (float), nVertices, fp);
-  if (nVerticesRead != nVertices)
+  uint32_t version = 0;
+  bool bounded = false;
+  if (nVertices == MODEL_MAGIC)
     {
-      cerr << nVerticesRead << " = nVerticesRead != nVertices = " << nVertices << endl;
-      exit (EXIT_FAILURE);
+      takeValue (file, version, "header");
+      bounded = version & MODEL_BOUNDED;
+      version &= ~MODEL_BOUNDED;
+      if (version != MODEL_VERSION && version != MODEL_VERSION_INTERLEAVED
+          && version != MODEL_VERSION_STREAM
+          && version != MODEL_VERSION_LOD && version != MODEL_VERSION_QUANTIZED
+          && version != MODEL_VERSION_CLUSTERS && version != MODEL_VERSION_SECTIONS)
+        {
+          cerr << "[allocModel] unsupported model version " << version << endl;
+          loadFailed ();
+        }
+      // headers are read whole, with their magic and version
+      file.cursor = 0;
     }
+  // bounds neither in the header nor cached are computed from the mapped positions, packed models have no cache
+  model_bounds *const missing = bounded || (file.ownsMapping && readBoundsCache (model3dFilePath, bounds))
+                                ? nullptr : &bounds;
+  computed = missing;
+  const auto takeBounds = [&] {
+    if (bounded)
+      takeValue (file, bounds, "bounds");
+  };
+  const auto checkIndexSize = [] (const uint32_t indexSize) {
+    if (indexSize != sizeof (GLushort) && indexSize != sizeof (GLuint))
+      {
+        cerr << "[allocModel] invalid index size " << indexSize << endl;
+        loadFailed ();
+      }
+  };
 
-  // read normals
-  auto *arrayOfNormals = (float *) malloc (3 * nVertices * sizeof (float));
-  const size_t nNormalsRead = fread (arrayOfNormals, 3 * sizeof (float), nVertices, fp);
-  if (nNormalsRead != nVertices)
+  struct model model;
+  if (version == MODEL_VERSION_SECTIONS)
     {
-      cerr << nNormalsRead << " = nNormalsRead != nVertices = " << nVertices << endl;
-      exit (EXIT_FAILURE);
+      model_sections_header header{};
+      takeValue (file, header, "header");
+      if (header.fileSize != file.size)
+        {
+          cerr << "[allocModel] " << model3dFilePath << " is " << file.size << " bytes, its header says "
+               << header.fileSize << endl;
+          loadFailed ();
+        }
+      if (header.headerSize < sizeof (header) || header.headerSize > file.size)
+        {
+          cerr << "[allocModel] invalid header size " << header.headerSize << endl;
+          loadFailed ();
+        }
+      checkIndexSize (header.indexSize);
+      cerr << "[allocModel] nVertices = " << header.nVertices << ", nIndices = " << header.nIndices
+           << ", nSections = " << header.nSections << endl;
+      // a later version may grow the header, the bounds follow all of it
+      file.cursor = header.headerSize;
+      takeBounds ();
+      model = readSectionedModel (file, header, missing);
+    }
+  else if (version == MODEL_VERSION_QUANTIZED)
+    {
+      model_quantized_header header{};
+      takeValue (file, header, "header");
+      checkIndexSize (header.indexSize);
+      cerr << "[allocModel] quantized nVertices = " << header.nVertices
+           << ", nIndices = " << header.nIndices << endl;
+      takeBounds ();
+      model = readQuantizedModel (file, header, missing);
+    }
+  else if (version == MODEL_VERSION_CLUSTERS)
+    {
+      model_cluster_header header{};
+      takeValue (file, header, "header");
+      checkIndexSize (header.indexSize);
+      cerr << "[allocModel] nVertices = " << header.nVertices << ", nIndices = " << header.nIndices
+           << ", nClusters = " << header.nClusters << endl;
+      takeBounds ();
+      model = readModel (file, (GLsizei) header.nVertices, (GLsizei) header.nIndices, header.indexSize,
+                         false, missing);
+      copyClusters (model, takeBytes (file, sizeof (model_cluster) * header.nClusters, "clusters"),
+                    header.nClusters, model3dFilePath);
     }
+  else if (version == MODEL_VERSION_LOD)
+    {
+      model_lod_header header{};
+      takeValue (file, header, "header");
+      if (header.nLevels == 0)
+        {
+          cerr << "[allocModel] no levels of detail in " << model3dFilePath << endl;
+          loadFailed ();
+        }
+      cerr << "[allocModel] nLevels = " << header.nLevels << endl;
+      takeBounds ();
 
-  // read texture coordinates
-  auto *arrayOfTextureCoordinates = (float *) malloc (2 * nVertices * sizeof (float));
-  const size_t nTextureCoordinatesRead = fread (arrayOfTextureCoordinates, 2 * sizeof (float), nVertices, fp);
-  if (nTextureCoordinatesRead != nVertices)
+      for (uint32_t level = 0; level < header.nLevels; ++level)
+        {
+          model_level_header level_header{};
+          takeValue (file, level_header, "level header");
+          checkIndexSize (level_header.indexSize);
+          cerr << "[allocModel] level " << level << ": nVertices = " << level_header.nVertices
+               << ", nIndices = " << level_header.nIndices << endl;
+          struct model level_model = readModel (file, (GLsizei) level_header.nVertices,
+                                                (GLsizei) level_header.nIndices, level_header.indexSize,
+                                                false, level == 0 ? missing : nullptr);
+          if (level == 0)
+            model = level_model;
+          else
+            model.lods.push_back (level_model);
+        }
+    }
+  else
     {
-      fprintf (stderr, "%zu = nTextureCoordinatesRead != nVertices = %ul", nTextureCoordinatesRead, nVertices);
-      exit (EXIT_FAILURE);
+      model_header header{};
+      if (version == MODEL_VERSION_STREAM)
+        {
+          // streamed models are unindexed, only their vertex count differs from legacy ones
+          model_stream_header stream_header{};
+          takeValue (file, stream_header, "header");
+          if (stream_header.nVertices > INT32_MAX)
+            {
+              cerr << "[allocModel] " << stream_header.nVertices << " vertices are too many to draw" << endl;
+              loadFailed ();
+            }
+          takeBounds ();
+          nVertices = (GLsizei) stream_header.nVertices;
+        }
+      else if (nVertices == MODEL_MAGIC)
+        {
+          takeValue (file, header, "header");
+          checkIndexSize (header.indexSize);
+          nVertices = (GLsizei) header.nVertices;
+          cerr << "[allocModel] nIndices = " << header.nIndices << endl;
+          takeBounds ();
+        }
+      else if (nVertices < 0)
+        {
+          cerr << "[allocModel] invalid number of vertices " << nVertices << endl;
+          loadFailed ();
+        }
+      cerr << "[allocModel] nVertices = " << nVertices << endl;
+      model = readModel (file, nVertices, (GLsizei) header.nIndices, header.indexSize,
+                         version == MODEL_VERSION_INTERLEAVED, missing);
     }
+  return model;
+}
 
-  fclose (fp);
+/*!
+ * Reads a mapped model file, on a loader thread, its buffers pending on file
+ * until uploadPendingBuffers copies them and the file is unmapped.
+ */
+struct model allocModel (mappedModelFile &file)
+{
+  model_bounds bounds{};
+  bool computed = false;
+  struct model model = readModelFile (file, bounds, computed);
+  setBounds (model, bounds);
+  cerr << "[allocModel] bounds " << (computed ? "computed" : "read") << ": center = " << to_string (model.center)
+       << ", radius = " << model.radius << endl;
+  if (computed && file.ownsMapping)
+    writeBoundsCache (file.path, bounds);
+  return model;
+}
 
+/*!
+ * Reads the streams of a model, or its interleaved vertices, and its indices
+ * unless indexSize is 0, leaving them pending on the mapped file (see @ref modelFormat).
+ *
+ * @param bounds set to the bounds of the positions unless nullptr.
+ */
+struct model readModel (mappedModelFile &file,
+                        const GLsizei nVertices,
+                        const GLsizei nIndices,
+                        const unsigned int indexSize,
+                        const bool interleaved,
+                        model_bounds *const bounds)
+{
   struct model model;
   model.nVertices = nVertices;
+  // interleaved or planar, vertices take 8 floats and the streams follow each other
+  const size_t verticesSize = 8 * sizeof (GLfloat) * (size_t) nVertices;
+  const char *const vertices = takeBytes (file, verticesSize, "vertices");
+  if (bounds)
+    *bounds = model_compute_bounds ((const float *) vertices, nVertices, interleaved ? 8 : 3);
+  if (interleaved)
+    {
+      model.pendingVertices = vertices;
+      model.pendingVerticesSize = (GLsizeiptr) verticesSize;
+    }
+  else
+    setPendingStreams (model, vertices, 3 * sizeof (GLfloat), vertices + 3 * sizeof (GLfloat) * nVertices,
+                       3 * sizeof (GLfloat), vertices + 6 * sizeof (GLfloat) * nVertices, 2 * sizeof (GLfloat));
 
-  // vertices buffer object array
-  const GLsizei sizeOfVertexArray = (GLsizei) sizeof (arrayOfVertices[0]) * 3 * model.nVertices;
-  glGenBuffers (1, &model.vbo);
-  glBindBuffer (GL_ARRAY_BUFFER, model.vbo);
-  glBufferData (GL_ARRAY_BUFFER, sizeOfVertexArray, arrayOfVertices, GL_STATIC_DRAW);
-  free (arrayOfVertices);
-
-  // normals buffer object array
-  const GLsizei sizeOfNormalsArray = (GLsizei) sizeof (arrayOfNormals[0]) * 3 * model.nVertices;
-  glGenBuffers (1, &model.normals);
-  glBindBuffer (GL_ARRAY_BUFFER, model.normals);
-  glBufferData (GL_ARRAY_BUFFER, sizeOfNormalsArray, arrayOfNormals, GL_STATIC_DRAW);
-  free (arrayOfNormals);
-
-  // texture coordinates buffer object array
-  const GLsizei sizeOfTextureCoordinateArray = (GLsizei) sizeof (arrayOfVertices[0]) * 2 * model.nVertices;
-  glGenBuffers (1, &model.tc);
-  glBindBuffer (GL_ARRAY_BUFFER, model.tc);
-  glBufferData (GL_ARRAY_BUFFER, sizeOfTextureCoordinateArray, arrayOfTextureCoordinates, GL_STATIC_DRAW);
-  free (arrayOfTextureCoordinates);
+  if (indexSize)
+    setPendingIndices (model, nIndices, indexSize, takeBytes (file, (size_t) indexSize * nIndices, "indices"));
+  return model;
+}
 
-  // unbind array buffer
-  glBindBuffer (GL_ARRAY_BUFFER, 0);
+/*!
+ * Reads the streams of a quantized model, pending on the mapped file, to be
+ * interleaved as they are uploaded and drawn with normalized and integer vertex formats
+ * (see @ref modelFormat and renderModel).
+ *
+ * @param bounds set to the bounds of the dequantized positions unless nullptr.
+ */
+struct model readQuantizedModel (mappedModelFile &file, const model_quantized_header &header,
+                                 model_bounds *const bounds)
+{
+  if (!GLEW_ARB_vertex_type_2_10_10_10_rev)
+    {
+      cerr << "[allocModel] quantized models need GL_ARB_vertex_type_2_10_10_10_rev" << endl;
+      loadFailed ();
+    }
 
+  struct model model;
+  model.nVertices = (GLsizei) header.nVertices;
+  model.positionOffset = glm::make_vec3 (header.positionOffset);
+  model.positionScale = header.positionScale;
+  model.textureOffset = glm::make_vec2 (header.textureOffset);
+  model.textureScale = glm::make_vec2 (header.textureScale);
+  model.normalType = GL_INT_2_10_10_10_REV;
+  model.texCoordType = GL_SHORT;
+
+  const bool quantizedPositions = header.attributes & MODEL_QUANTIZED_POSITIONS;
+  const size_t positionSize = quantizedPositions ? 4 * sizeof (GLshort) : 3 * sizeof (GLfloat);
+  if (quantizedPositions)
+    model.vertexType = GL_SHORT;
+
+  const size_t verticesSize = (positionSize + sizeof (GLuint) + 2 * sizeof (GLshort)) * header.nVertices;
+  const char *const vertices = takeBytes (file, verticesSize, "vertices");
+  setPendingStreams (model, vertices, positionSize, vertices + positionSize * header.nVertices, sizeof (GLuint),
+                     vertices + (positionSize + sizeof (GLuint)) * header.nVertices, 2 * sizeof (GLshort));
+  if (bounds && quantizedPositions)
+    *bounds = dequantizedBounds (model, (const GLshort *) vertices);
+  else if (bounds)
+    *bounds = model_compute_bounds ((const float *) vertices, header.nVertices);
+
+  setPendingIndices (model, (GLsizei) header.nIndices, header.indexSize,
+                 takeBytes (file, (size_t) header.indexSize * header.nIndices, "indices"));
   return model;
 }
 
-void associate_a_texture_to_model (struct model &m, const char *const path)
+/*!
+ * Reads the sections of a sectioned model, pending on the mapped file: its
+ * vertex streams, or interleaved vertices, and its indices. Its clusters, if
+ * any, are copied.
+ *
+ * @param bounds set to the bounds of the positions unless nullptr.
+ */
+struct model readSectionedModel (mappedModelFile &file, const model_sections_header &header,
+                                 model_bounds *const bounds)
 {
+  const model_section *sections[MODEL_SECTION_CLUSTERS + 1] = {};
+  vector<model_section> table (header.nSections);
+  memcpy (table.data (), takeBytes (file, sizeof (model_section) * table.size (), "section table"),
+          sizeof (model_section) * table.size ());
+  for (const auto &section : table)
+    {
+      if (section.offset % MODEL_SECTION_ALIGNMENT || section.offset > file.size
+          || section.size > file.size - section.offset)
+        {
+          cerr << "[allocModel] section " << section.type << " out of place in " << file.path << endl;
+          loadFailed ();
+        }
+      // sections of unknown types are skipped
+      if (section.type < std::size (sections))
+        sections[section.type] = &section;
+    }
+  const auto section = [&] (const uint32_t type, const uint64_t size, const char *const what) {
+    if (!sections[type] || sections[type]->size != size)
+      {
+        cerr << "[allocModel] missing or mis-sized " << what << " in " << file.path << endl;
+        loadFailed ();
+      }
+    return sections[type];
+  };
+
+  struct model model;
+  model.nVertices = (GLsizei) header.nVertices;
+  const size_t nVertices = header.nVertices;
+  if (sections[MODEL_SECTION_INTERLEAVED])
+    {
+      const auto *const vertices = section (MODEL_SECTION_INTERLEAVED, 8 * sizeof (GLfloat) * nVertices,
+                                            "interleaved vertices");
+      if (bounds)
+        *bounds = model_compute_bounds ((const float *) (file.data + vertices->offset), nVertices, 8);
+      model.pendingVertices = file.data + vertices->offset;
+      model.pendingVerticesSize = (GLsizeiptr) vertices->size;
+    }
+  else
+    {
+      const auto *const positions = section (MODEL_SECTION_POSITIONS, 3 * sizeof (GLfloat) * nVertices, "positions");
+      const auto *const normals = section (MODEL_SECTION_NORMALS, 3 * sizeof (GLfloat) * nVertices, "normals");
+      const auto *const texture = section (MODEL_SECTION_TEXTURE, 2 * sizeof (GLfloat) * nVertices,
+                                           "texture coordinates");
+      if (bounds)
+        *bounds = model_compute_bounds ((const float *) (file.data + positions->offset), nVertices);
+      setPendingStreams (model, file.data + positions->offset, 3 * sizeof (GLfloat),
+                         file.data + normals->offset, 3 * sizeof (GLfloat),
+                         file.data + texture->offset, 2 * sizeof (GLfloat));
+    }
+
+  const auto *const indices = section (MODEL_SECTION_INDICES, (uint64_t) header.indexSize * header.nIndices,
+                                       "indices");
+  setPendingIndices (model, (GLsizei) header.nIndices, header.indexSize, file.data + indices->offset);
+  if (header.nClusters)
+    {
+      const auto *const clusters = section (MODEL_SECTION_CLUSTERS, sizeof (model_cluster) * header.nClusters,
+                                            "clusters");
+      copyClusters (model, file.data + clusters->offset, header.nClusters, file.path);
+    }
+  return model;
+}
+
+//! The streams and indices of a model built by generateModel.
+struct generatedModel {
+  model_vector<vec3> vertices;
+  model_vector<vec3> normals;
+  model_vector<vec2> texture;
+  vector<uint32_t> indices;
+};
+
+/*!
+ * Builds a model in memory from a generator ⟨model⟩ (its ⟨out_file⟩ is not
+ * written), instead of running the generator and loading the file back. Its
+ * buffers are pending on the streams and indices of generated.
+ */
+struct model generateModel (const char *const generatorArgv, generatedModel &generated)
+{
+  cerr << "[generateModel] generator " << generatorArgv << endl;
+  std::istringstream words (generatorArgv);
+  vector<string> argv_words{"generator"};
+  for (string word; words >> word;)
+    argv_words.push_back (word);
+  vector<const char *> argv;
+  for (const auto &word : argv_words)
+    argv.push_back (word.c_str ());
+
+  if (!model_check ((int) argv.size () - 1, argv.data ()))
+    loadFailed ();
+  generate_model ((int) argv.size () - 1, argv.data (), generated.vertices, generated.normals, generated.texture);
+  const size_t nUnweldedVertices = generated.vertices.size ();
+  model_weld (generated.vertices, generated.normals, generated.texture, generated.indices);
+  cerr << "[generateModel] nVertices = " << generated.vertices.size ()
+       << " (welded from " << nUnweldedVertices << "), nIndices = " << generated.indices.size () << endl;
+
+  struct model model;
+  model.nVertices = (GLsizei) generated.vertices.size ();
+  setPendingStreams (model, generated.vertices.data (), 3 * sizeof (GLfloat), generated.normals.data (),
+                     3 * sizeof (GLfloat), generated.texture.data (), 2 * sizeof (GLfloat));
+  setPendingIndices (model, (GLsizei) generated.indices.size (), sizeof (uint32_t), generated.indices.data ());
+  setBounds (model, model_compute_bounds ((const float *) generated.vertices.data (), generated.vertices.size ()));
+  return model;
+}
+
+//! Sets a model's indices, nIndices of indexSize bytes, to be copied to its index buffer object.
+void setPendingIndices (struct model &model,
+                        const GLsizei nIndices,
+                        const unsigned int indexSize,
+                        const void *const arrayOfIndices)
+{
+  model.nIndices = nIndices;
+  model.indexType = indexSize == sizeof (GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  model.pendingIndices = arrayOfIndices;
+}
+
+/*!
+ * Copies the pending streams of a model (see setPendingStreams) to a new buffer
+ * object, interleaving them on the way. They are written straight into the
+ * buffer's mapping or, without GL_ARB_map_buffer_range, through a copy.
+ */
+static GLuint uploadInterleaved (const struct model &model)
+{
+  const size_t sizes[3] = {(size_t) model.normalOffset, (size_t) (model.texCoordOffset - model.normalOffset),
+                           (size_t) (model.vertexStride - model.texCoordOffset)};
+  const char *const streams[3] = {(const char *) model.pendingVertices, (const char *) model.pendingNormals,
+                                  (const char *) model.pendingTexCoords};
+  const auto interleave = [&] (char *const vertices) {
+    size_t offset = 0;
+    for (int s = 0; s < 3; ++s)
+      {
+        for (size_t v = 0; v < (size_t) model.nVertices; ++v)
+          memcpy (vertices + model.vertexStride * v + offset, streams[s] + sizes[s] * v, sizes[s]);
+        offset += sizes[s];
+      }
+  };
+
+  GLuint buffer = uploadBuffer (model.pendingVerticesSize, nullptr);
+  glBindBuffer (GL_ARRAY_BUFFER, buffer);
+  bool written = false;
+  if (GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range)
+    if (void *const mapping = glMapBufferRange (GL_ARRAY_BUFFER, 0, model.pendingVerticesSize,
+                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT))
+      {
+        interleave ((char *) mapping);
+        // false when the mapping was lost, e.g. to a mode switch
+        written = glUnmapBuffer (GL_ARRAY_BUFFER);
+      }
+  if (!written)
+    {
+      vector<char> vertices (model.pendingVerticesSize);
+      interleave (vertices.data ());
+      glBufferSubData (GL_ARRAY_BUFFER, 0, model.pendingVerticesSize, vertices.data ());
+    }
+  glBindBuffer (GL_ARRAY_BUFFER, 0);
+  return buffer;
+}
+
+/*!
+ * Copies the pending buffers of a model, and of its levels of detail, to buffer
+ * objects, and returns their size in bytes.
+ */
+static GLsizeiptr uploadPendingBuffers (struct model &model)
+{
+  GLsizeiptr bytes = 0;
+  if (model.pendingNormals)
+    {
+      model.vbo = uploadInterleaved (model);
+      bytes += model.pendingVerticesSize;
+    }
+  else if (model.pendingVertices)
+    {
+      model.vbo = uploadBuffer (model.pendingVerticesSize, model.pendingVertices);
+      bytes += model.pendingVerticesSize;
+    }
+  if (model.pendingIndices)
+    {
+      const GLsizeiptr indexSize = model.indexType == GL_UNSIGNED_SHORT ? sizeof (GLushort) : sizeof (GLuint);
+      glGenBuffers (1, &model.ibo);
+      glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, model.ibo);
+      glBufferData (GL_ELEMENT_ARRAY_BUFFER, indexSize * model.nIndices, model.pendingIndices, GL_STATIC_DRAW);
+      glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, 0);
+      bytes += indexSize * model.nIndices;
+    }
+  model.pendingVertices = model.pendingIndices = nullptr;
+  model.pendingNormals = model.pendingTexCoords = nullptr;
+  for (auto &level : model.lods)
+    bytes += uploadPendingBuffers (level);
+  return bytes;
+}
+
+//! An image decoded to RGBA by a loader thread, waiting for its upload.
+struct decodedTexture {
+  GLsizei width = 0;
+  GLsizei height = 0;
+  vector<ILubyte> pixels;
+  //! the image, in pixels, in a scene pack's mapping or in a texture cache entry
+  const ILubyte *data = nullptr;
+  //! the levels after the first, one after the other, null to generate them on upload
+  const ILubyte *mips = nullptr;
+  vector<ILubyte> mipStorage;
+  //! the texture cache entry data and mips are mapped from, unmapped once uploaded
+  const unsigned char *cached = nullptr;
+  size_t cachedSize = 0;
+};
+
+/*!
+ * Decodes an image file to RGBA. DevIL keeps a single current image, so images
+ * are decoded one at a time and copied out of it, leaving DevIL free for the
+ * next one while this one waits for its upload.
+ */
+static void decodeTexture (const char *const path, decodedTexture &texture)
+{
+  static std::mutex devilMutex;
+  const std::lock_guard<std::mutex> lock (devilMutex);
 
   static bool isFirstTimeBeingExecuted = true;
   if (isFirstTimeBeingExecuted)
@@ -988,7 +1674,7 @@ void associate_a_texture_to_model (struct model &m, const char *const path)
     {
       cerr << "[engine] failed loading texture file '" << path << "'"
            << "\nERROR#" << ilGetError () << endl;
-      exit (EXIT_FAILURE);
+      loadFailed ();
     }
 
   // convert to RGBA (slide 6) [class11]
@@ -996,9 +1682,49 @@ void associate_a_texture_to_model (struct model &m, const char *const path)
   if (!has_converted_image_sucessfully)
     {
       cerr << "[engine] failed to convert texture '" << path << "'" << endl;
-      exit (EXIT_FAILURE);
+      loadFailed ();
+    }
+
+  // get the required info (slide 7) [class11]
+  const ILubyte *const texData = ilGetData ();
+  texture.width = ilGetInteger (IL_IMAGE_WIDTH);
+  texture.height = ilGetInteger (IL_IMAGE_HEIGHT);
+  texture.pixels.assign (texData, texData + 4 * (size_t) texture.width * texture.height);
+  texture.data = texture.pixels.data ();
+  ilDeleteImages (1, &image);
+
+  isFirstTimeBeingExecuted = false;
+}
+
+/*!
+ * Maps an image, and its mip chain, from the texture cache (see @ref
+ * textureCache), or decodes it, builds its mip chain and stores both in the
+ * cache for the next time.
+ */
+static void loadTexture (const char *const path, decodedTexture &texture)
+{
+  uint64_t hash;
+  const string entry = texture_cache_entry (path, hash);
+  texture_cache_header header{};
+  if (!entry.empty () && (texture.cached = texture_cache_map (entry, hash, header, texture.cachedSize)))
+    {
+      cerr << "[engine] texture " << path << " mapped from " << entry << endl;
+      texture.width = (GLsizei) header.width;
+      texture.height = (GLsizei) header.height;
+      texture.data = texture.cached + sizeof (header);
+      texture.mips = texture.data + 4 * (size_t) texture.width * texture.height;
+      return;
     }
 
+  decodeTexture (path, texture);
+  texture.mipStorage = texture_mip_chain (texture.width, texture.height, texture.data);
+  texture.mips = texture.mipStorage.data ();
+  if (!entry.empty ())
+    texture_cache_store (entry, hash, texture.width, texture.height, texture.data, texture.mipStorage);
+}
+
+void associate_a_texture_to_model (struct model &m, const decodedTexture &texture)
+{
   // texture creation in OpenGL (slide 8) [class11]
   // create a texture slot (slide 8) [class11]
   glGenTextures (1, &m.tbo);
@@ -1013,43 +1739,534 @@ void associate_a_texture_to_model (struct model &m, const char *const path)
   glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
   glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-  // get the required info (slide 7) [class11]
-  const ILubyte *const texData = ilGetData ();
-  const GLsizei texture_width = ilGetInteger (IL_IMAGE_WIDTH);
-  const GLsizei texture_height = ilGetInteger (IL_IMAGE_HEIGHT);
-
   // send texture data to OpenGL (slide 8) [class11]
   glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA,
-                texture_width, texture_height, 0,
-                GL_RGBA, GL_UNSIGNED_BYTE, texData);
+                texture.width, texture.height, 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, texture.data);
 
-  glGenerateMipmap (GL_TEXTURE_2D);
+  if (texture.mips)
+    {
+      // the whole chain is precomputed, see texture_cache.h
+      GLsizei width = texture.width, height = texture.height;
+      const ILubyte *level = texture.mips;
+      for (GLint l = 1; width > 1 || height > 1; ++l)
+        {
+          width = std::max (1, width / 2);
+          height = std::max (1, height / 2);
+          glTexImage2D (GL_TEXTURE_2D, l, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level);
+          level += 4 * (size_t) width * height;
+        }
+    }
+  else
+    glGenerateMipmap (GL_TEXTURE_2D);
 
   // unbind texture
   glBindTexture (GL_TEXTURE_2D, 0);
+}
 
-  isFirstTimeBeingExecuted = false;
+/*! @addtogroup assetLoading
+ * @{
+ * Models and textures are loaded while the scene is already drawn. The first
+ * pass of operations_render only queues them, behind placeholders in
+ * globalModels, to loader threads that read model files, run generators and
+ * decode images. The main thread, which alone may call OpenGL, uploads what
+ * is ready at the start of every frame, for at most globalUploadBudgetMs, and
+ * draws every model whose assets are all uploaded.
+ *
+ * Assets are shared: models that name the same model file, generator ⟨model⟩
+ * or texture file get the same buffer objects, or texture object, loaded and
+ * uploaded once (see sharedAsset).
+ */
+
+//! Milliseconds of every frame spent uploading loaded assets, at least one asset is uploaded per frame.
+const double DEFAULT_UPLOAD_BUDGET_MS = 4;
+static double globalUploadBudgetMs = DEFAULT_UPLOAD_BUDGET_MS;
+
+//! When the engine started, time to first frame and to fully loaded are measured from it.
+static const auto globalStartTime = std::chrono::steady_clock::now ();
+
+enum assetKind {
+  MODEL_FILE,
+  GENERATED_MODEL,
+  TEXTURE_FILE,
+};
+
+/*!
+ * A model or a texture, uploaded once for every model that names it, by its
+ * canonical path, or its generator ⟨model⟩ without the ⟨out_file⟩. Textures are
+ * all uploaded with the same parameters, so their file is enough to share them.
+ */
+struct sharedAsset {
+  assetKind kind;
+  //! the uploaded model, only its tbo for a texture
+  struct model uploaded;
+  bool isUploaded = false;
+  //! indices in globalModels of the models waiting for the upload
+  vector<size_t> waiting;
+  //! models sharing the asset
+  size_t references = 0;
+  //! GPU memory of the asset, which every reference but the first would otherwise take again
+  size_t bytes = 0;
+};
+//! Every asset queued, entries are never moved so loads point to them.
+static std::map<std::pair<assetKind, string>, sharedAsset> globalSharedAssets;
+
+//! A model, or a model's texture, loaded by a loader thread then uploaded by the main thread.
+struct assetLoad {
+  assetKind kind;
+  //! the asset it uploads, shared by the models waiting for it
+  sharedAsset *asset;
+  //! model file, generator ⟨model⟩ or texture file
+  string path;
+  //! what the loader thread read, the model's pending buffers point into file or generated
+  struct model loaded;
+  mappedModelFile file{};
+  generatedModel generated;
+  decodedTexture texture;
+  //! set by the loader thread when the asset could not be loaded, the reason already reported
+  bool failed = false;
+};
+
+//! Assets waiting for a loader thread, and assets loaded waiting for their upload.
+struct assetQueues {
+  std::mutex mutex;
+  std::condition_variable queued;
+  std::deque<std::unique_ptr<assetLoad>> loading;
+  std::deque<std::unique_ptr<assetLoad>> loaded;
+};
+//! never destroyed, exiting would otherwise wait on the loader threads blocked on it
+static assetQueues &globalAssetQueues = *new assetQueues;
+//! assets queued and not yet uploaded, only touched by the main thread
+static size_t globalAssetsLoading = 0;
+static size_t globalAssetsLoaded = 0;
+
+//! The scene pack the world was loaded from, mapped for as long as the engine runs, or none.
+struct scenePack {
+  const char *data = nullptr;
+  size_t size = 0;
+  vector<pack_entry> entries;
+};
+static scenePack globalScenePack;
+
+/*!
+ * Maps a scene pack (see @ref packFormat) and checks its entries, false if the
+ * file is not a scene pack.
+ */
+static bool openScenePack (const char *const path)
+{
+  const mappedModelFile file = mapModelFile (path);
+  pack_header header{};
+  if (file.size >= sizeof (header))
+    memcpy (&header, file.data, sizeof (header));
+  if (header.magic != PACK_MAGIC)
+    {
+      unmapModelFile (file);
+      return false;
+    }
+  if (header.version != PACK_VERSION || header.fileSize != file.size
+      || header.nEntries == 0 || header.nEntries > (file.size - sizeof (header)) / sizeof (pack_entry))
+    {
+      cerr << "[engine] invalid scene pack " << path << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  vector<pack_entry> entries (header.nEntries);
+  memcpy (entries.data (), file.data + sizeof (header), sizeof (pack_entry) * entries.size ());
+  for (const auto &entry : entries)
+    if (entry.offset % PACK_ALIGNMENT || entry.offset > file.size || entry.size > file.size - entry.offset
+        || entry.nameOffset > file.size || entry.nameSize > file.size - entry.nameOffset
+        || (entry.type == PACK_ENTRY_TEXTURE && entry.size != 4 * (uint64_t) entry.width * entry.height))
+      {
+        cerr << "[engine] entry out of place in scene pack " << path << endl;
+        exit (EXIT_FAILURE);
+      }
+  if (entries[0].type != PACK_ENTRY_WORLD)
+    {
+      cerr << "[engine] scene pack " << path << " does not start with its world" << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  cerr << "[engine] scene pack " << path << ": " << entries.size () << " entries, " << file.size << " bytes" << endl;
+  globalScenePack.data = file.data;
+  globalScenePack.size = file.size;
+  globalScenePack.entries = std::move (entries);
+  return true;
+}
+
+//! The entry of the scene pack a packed world names `#` ⟨index⟩, failing (see loadFailed) if it is not one of type.
+static const pack_entry &scenePackEntry (const string &name, const uint32_t type)
+{
+  char *end = nullptr;
+  const unsigned long index = name[0] == '#' ? strtoul (name.c_str () + 1, &end, 10) : 0;
+  if (!end || *end || end == name.c_str () + 1 || index >= globalScenePack.entries.size ()
+      || globalScenePack.entries[index].type != type)
+    {
+      cerr << "[engine] " << name << " is not a " << (type == PACK_ENTRY_MODEL ? "model" : "texture")
+           << " of the scene pack" << endl;
+      loadFailed ();
+    }
+  return globalScenePack.entries[index];
+}
+
+//! Reads or decodes an asset, on a loader thread, from its file or the scene pack.
+static void loadAsset (assetLoad &load)
+{
+  switch (load.kind)
+    {
+      case MODEL_FILE:
+        if (globalScenePack.data)
+          {
+            const pack_entry &entry = scenePackEntry (load.path, PACK_ENTRY_MODEL);
+            load.file = {load.path.c_str (), globalScenePack.data + entry.offset, entry.size, 0, false};
+          }
+        else
+          load.file = mapModelFile (load.path.c_str ());
+        load.loaded = allocModel (load.file);
+      break;
+      case GENERATED_MODEL:
+        load.loaded = generateModel (load.path.c_str (), load.generated);
+      break;
+      case TEXTURE_FILE:
+        if (globalScenePack.data)
+          {
+            // packed textures are already decoded
+            const pack_entry &entry = scenePackEntry (load.path, PACK_ENTRY_TEXTURE);
+            load.texture.width = (GLsizei) entry.width;
+            load.texture.height = (GLsizei) entry.height;
+            load.texture.data = (const ILubyte *) globalScenePack.data + entry.offset;
+          }
+        else
+          loadTexture (load.path.c_str (), load.texture);
+      break;
+    }
+}
+
+/*!
+ * Loads queued assets until the process exits. There is a loader thread per
+ * hardware thread already, so generators run serially on each one (see
+ * parallel_for_serial).
+ */
+static void loaderThread ()
+{
+  globalIsLoader = true;
+  parallel_for_serial ();
+  for (;;)
+    {
+      std::unique_lock<std::mutex> lock (globalAssetQueues.mutex);
+      globalAssetQueues.queued.wait (lock, [] { return !globalAssetQueues.loading.empty (); });
+      std::unique_ptr<assetLoad> load = std::move (globalAssetQueues.loading.front ());
+      globalAssetQueues.loading.pop_front ();
+      lock.unlock ();
+
+      try
+        {
+          loadAsset (*load);
+        }
+      catch (const assetLoadFailure &)
+        {
+          load->failed = true;
+        }
+
+      lock.lock ();
+      globalAssetQueues.loaded.push_back (std::move (load));
+    }
+}
+
+//! The key an asset is shared by, see sharedAsset.
+static std::pair<assetKind, string> sharedAssetKey (const assetKind kind, const string &path)
+{
+  if (kind == GENERATED_MODEL)
+    {
+      std::istringstream words (path);
+      vector<string> argv_words;
+      for (string word; words >> word;)
+        argv_words.push_back (word);
+      string model;
+      for (size_t w = 0; w + 1 < argv_words.size (); ++w)
+        model += (w ? " " : "") + argv_words[w];
+      return {kind, model};
+    }
+  // packed files are already named by their entry
+  if (globalScenePack.data)
+    return {kind, path};
+  std::error_code error;
+  const auto canonical = std::filesystem::weakly_canonical (path, error);
+  return {kind, error ? path : canonical.string ()};
+}
+
+//! Gives globalModels[model] an uploaded asset, keeping what the scene set on it.
+static void shareAsset (const sharedAsset &asset, const size_t model_index)
+{
+  struct model &model = globalModels[model_index];
+  if (asset.kind != TEXTURE_FILE)
+    {
+      struct model shared = asset.uploaded;
+      shared.material = model.material;
+      shared.closed = model.closed;
+      shared.tbo = model.tbo;
+      shared.loading = model.loading;
+      model = std::move (shared);
+    }
+  else
+    model.tbo = asset.uploaded.tbo;
+  --model.loading;
+  --globalAssetsLoading;
+  ++globalAssetsLoaded;
+}
+
+/*!
+ * Queues an asset of globalModels[model], which is not drawn until it is
+ * uploaded, unless another model already queued it. The loader threads, one
+ * per hardware thread, start with the first asset.
+ */
+static void queueAsset (const assetKind kind, const size_t model, const string &path)
+{
+  static bool hasStartedLoaders = false;
+  if (!hasStartedLoaders)
+    {
+      const unsigned int nThreads = std::max (1u, std::thread::hardware_concurrency ());
+      for (unsigned int t = 0; t < nThreads; ++t)
+        std::thread (loaderThread).detach ();
+      hasStartedLoaders = true;
+    }
+
+  ++globalModels[model].loading;
+  ++globalAssetsLoading;
+  sharedAsset &asset = globalSharedAssets[sharedAssetKey (kind, path)];
+  if (asset.references++)
+    {
+      if (asset.isUploaded)
+        shareAsset (asset, model);
+      else
+        asset.waiting.push_back (model);
+      return;
+    }
+  asset.kind = kind;
+  asset.waiting.push_back (model);
+
+  auto load = std::make_unique<assetLoad> ();
+  load->kind = kind;
+  load->asset = &asset;
+  load->path = path;
+  {
+    const std::lock_guard<std::mutex> lock (globalAssetQueues.mutex);
+    globalAssetQueues.loading.push_back (std::move (load));
+  }
+  globalAssetQueues.queued.notify_one ();
+}
+
+//! Uploads a loaded asset and gives it to every model waiting for it.
+static void uploadAsset (assetLoad &load)
+{
+  sharedAsset &asset = *load.asset;
+  if (load.kind == TEXTURE_FILE)
+    {
+      associate_a_texture_to_model (asset.uploaded, load.texture);
+      texture_cache_unmap (load.texture.cached, load.texture.cachedSize);
+      // the mipmaps take another third
+      asset.bytes = 4 * (size_t) load.texture.width * load.texture.height * 4 / 3;
+    }
+  else
+    {
+      asset.bytes = uploadPendingBuffers (load.loaded);
+      if (load.kind == MODEL_FILE)
+        unmapModelFile (load.file);
+      asset.uploaded = std::move (load.loaded);
+    }
+  asset.isUploaded = true;
+  for (const size_t model : asset.waiting)
+    shareAsset (asset, model);
+  asset.waiting = {};
+}
+
+/*!
+ * Uploads loaded assets, on the main thread, until globalUploadBudgetMs have
+ * passed, and reports the time to fully loaded once nothing is left.
+ */
+void uploadLoadedAssets ()
+{
+  const auto start = std::chrono::steady_clock::now ();
+  while (globalAssetsLoading)
+    {
+      std::unique_ptr<assetLoad> load;
+      {
+        const std::lock_guard<std::mutex> lock (globalAssetQueues.mutex);
+        if (globalAssetQueues.loaded.empty ())
+          break;
+        load = std::move (globalAssetQueues.loaded.front ());
+        globalAssetQueues.loaded.pop_front ();
+      }
+      if (load->failed)
+        {
+          cerr << "[engine] failed loading " << load->path << endl;
+          exit (EXIT_FAILURE);
+        }
+      uploadAsset (*load);
+      if (!globalAssetsLoading)
+        {
+          size_t saved = 0;
+          for (const auto &shared : globalSharedAssets)
+            saved += shared.second.bytes * (shared.second.references - 1);
+          cerr << "[engine] fully loaded " << globalAssetsLoaded << " assets (" << globalSharedAssets.size ()
+               << " uploaded, sharing saved " << saved << " bytes of GPU memory) after "
+               << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - globalStartTime).count ()
+               << " ms" << endl;
+        }
+      if (std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ()
+          >= globalUploadBudgetMs)
+        break;
+    }
+}
+
+//! @} end of group assetLoading
+
+/*!
+ * Picks a model's level of detail from the diameter, in pixels, of its bounding
+ * sphere under the current modelview and projection matrices. Level k ≥ 1, i.e.
+ * model.lods[k - 1], is drawn below globalLodPixels / 2ᵏ⁻¹ pixels.
+ */
+const struct model &selectLevelOfDetail (const struct model &model)
+{
+  if (model.lods.empty ())
+    return model;
+
+  GLfloat modelview[16], projection[16];
+  GLint viewport[4];
+  glGetFloatv (GL_MODELVIEW_MATRIX, modelview);
+  glGetFloatv (GL_PROJECTION_MATRIX, projection);
+  glGetIntegerv (GL_VIEWPORT, viewport);
+
+  // the center of the model's bounding sphere in eye space, and the largest scale of its axes
+  const float z = modelview[2] * model.center.x + modelview[6] * model.center.y
+                  + modelview[10] * model.center.z + modelview[14];
+  if (z >= 0)
+    return model;
+  float scale = 0;
+  for (int axis = 0; axis < 3; ++axis)
+    scale = std::max (scale, glm::length (glm::make_vec3 (modelview + 4 * axis)));
+
+  const float pixels = model.radius * scale * projection[5] / -z * (float) viewport[3];
+  if (pixels >= globalLodPixels)
+    return model;
+  const auto level = (size_t) log2f (globalLodPixels / pixels) + 1;
+  return model.lods[std::min (level, model.lods.size ()) - 1];
+}
+
+/*!
+ * Collects the index ranges of the clusters of a model that may be visible under
+ * the current modelview and projection matrices, merging adjacent ones. A
+ * cluster is skipped when its bounding sphere is outside the frustum or, when
+ * the model is closed or back faces are culled, when its normal cone faces away
+ * from the camera.
+ */
+void cullClusters (const struct model &model, const bool closed, vector<GLsizei> &counts,
+                   vector<const void *> &offsets)
+{
+  GLfloat modelviewArray[16], projectionArray[16];
+  glGetFloatv (GL_MODELVIEW_MATRIX, modelviewArray);
+  glGetFloatv (GL_PROJECTION_MATRIX, projectionArray);
+  const mat4 modelview = glm::make_mat4 (modelviewArray);
+  const mat4 projection = glm::make_mat4 (projectionArray);
+
+  // frustum planes in eye space (Gribb and Hartmann), inside where dot(plane, point) ≥ 0
+  vec4 planes[6];
+  const mat4 rows = glm::transpose (projection);
+  for (int axis = 0; axis < 3; ++axis)
+    {
+      planes[2 * axis] = rows[3] + rows[axis];
+      planes[2 * axis + 1] = rows[3] - rows[axis];
+    }
+  for (auto &plane : planes)
+    plane /= glm::length (vec3 (plane));
+  float scale = 0;
+  for (int axis = 0; axis < 3; ++axis)
+    scale = std::max (scale, glm::length (vec3 (modelview[axis])));
+
+  GLint cullFaceMode, frontFace;
+  glGetIntegerv (GL_CULL_FACE_MODE, &cullFaceMode);
+  glGetIntegerv (GL_FRONT_FACE, &frontFace);
+  const bool backFacesCulled = closed
+                               || (glIsEnabled (GL_CULL_FACE) && cullFaceMode == GL_BACK && frontFace == GL_CCW);
+  const vec3 camera = vec3 (glm::inverse (modelview)[3]);
+
+  counts.clear ();
+  offsets.clear ();
+  const GLsizei indexSize = model.indexType == GL_UNSIGNED_SHORT ? sizeof (GLushort) : sizeof (GLuint);
+  for (const auto &cluster : model.clusters)
+    {
+      const vec3 center = glm::make_vec3 (cluster.center);
+      const vec4 eyeCenter = modelview * vec4 (center, 1);
+      bool visible = true;
+      for (const auto &plane : planes)
+        visible = visible && glm::dot (plane, eyeCenter) >= -cluster.radius * scale;
+      if (visible && backFacesCulled)
+        {
+          const vec3 view = center - camera;
+          visible = glm::dot (view, glm::make_vec3 (cluster.coneAxis))
+                    < cluster.coneCutoff * glm::length (view) + cluster.radius;
+        }
+      if (!visible)
+        continue;
+
+      const auto offset = (const char *) nullptr + (size_t) cluster.firstIndex * indexSize;
+      if (!counts.empty () && (const char *) offsets.back () + (size_t) counts.back () * indexSize == offset)
+        counts.back () += (GLsizei) cluster.nIndices;
+      else
+        {
+          counts.push_back ((GLsizei) cluster.nIndices);
+          offsets.push_back (offset);
+        }
+    }
 }
 
 void renderModel (const struct model &model)
 {
+  // still loading (see @ref assetLoading)
+  if (model.loading)
+    return;
+
   if (!model.nVertices % 3)
     {
       fprintf (stderr, "Number of coordinates (%d) is not divisible by 3", model.nVertices);
       exit (1);
     }
 
-  // vertex buffer object (slide 14) [class11]
-  glBindBuffer (GL_ARRAY_BUFFER, model.vbo);
-  glVertexPointer (3, GL_FLOAT, 0, nullptr);
+  const struct model &level = selectLevelOfDetail (model);
+
+  // culled before the dequantizing transforms below, cluster bounds are in model space
+  static vector<GLsizei> clusterCounts;
+  static vector<const void *> clusterOffsets;
+  if (!level.clusters.empty ())
+    cullClusters (level, model.closed, clusterCounts, clusterOffsets);
+
+  // vertex buffer object (slide 14) [class11], its vertices interleaved (see setPendingStreams)
+  glBindBuffer (GL_ARRAY_BUFFER, level.vbo);
+  glVertexPointer (3, level.vertexType, level.vertexStride, nullptr);
 
   // normals (slide 14) [class11]
-  glBindBuffer (GL_ARRAY_BUFFER, model.normals);
-  glNormalPointer (GL_FLOAT, 0, nullptr);
+  glNormalPointer (level.normalType, level.normalStride, (const void *) level.normalOffset);
 
   // texture coordinates (slide 14) [class11]
-  glBindBuffer (GL_ARRAY_BUFFER, model.tc);
-  glTexCoordPointer (2, GL_FLOAT, 0, nullptr);
+  glTexCoordPointer (2, level.texCoordType, level.texCoordStride, (const void *) level.texCoordOffset);
+
+  // quantized positions and texture coordinates are dequantized by the modelview
+  // and texture matrices, GL_RESCALE_NORMAL undoes the uniform scale on normals
+  const bool dequantizePositions = level.vertexType != GL_FLOAT;
+  const bool dequantizeTexture = level.texCoordType != GL_FLOAT;
+  if (dequantizePositions)
+    {
+      glPushMatrix ();
+      glTranslatef (level.positionOffset.x, level.positionOffset.y, level.positionOffset.z);
+      glScalef (level.positionScale, level.positionScale, level.positionScale);
+    }
+  if (dequantizeTexture)
+    {
+      glMatrixMode (GL_TEXTURE);
+      glPushMatrix ();
+      glTranslatef (level.textureOffset.x, level.textureOffset.y, 0);
+      glScalef (level.textureScale.x, level.textureScale.y, 1);
+      glMatrixMode (GL_MODELVIEW);
+    }
 
   // texture buffer object (slide 14) [class11]
   glBindTexture (GL_TEXTURE_2D, model.tbo);
@@ -1063,9 +2280,32 @@ void renderModel (const struct model &model)
   glMaterialf (GL_FRONT, GL_SHININESS, model.material.shininess);
 
   // drawing
-  glDrawArrays (GL_TRIANGLES, 0, model.nVertices);
+  if (level.ibo && !level.clusters.empty ())
+    {
+      glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, level.ibo);
+      glMultiDrawElements (GL_TRIANGLES, clusterCounts.data (), level.indexType,
+                           clusterOffsets.data (), (GLsizei) clusterCounts.size ());
+      glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+  else if (level.ibo)
+    {
+      glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, level.ibo);
+      glDrawElements (GL_TRIANGLES, level.nIndices, level.indexType, nullptr);
+      glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+  else
+    glDrawArrays (GL_TRIANGLES, 0, level.nVertices);
   //glPopAttrib ();
 
+  if (dequantizeTexture)
+    {
+      glMatrixMode (GL_TEXTURE);
+      glPopMatrix ();
+      glMatrixMode (GL_MODELVIEW);
+    }
+  if (dequantizePositions)
+    glPopMatrix ();
+
   // unbind array buffer
   glBindBuffer (GL_ARRAY_BUFFER, 0);
   // unbind texture (slide 10) [class11]
@@ -1290,7 +2530,7 @@ void operations_render (vector<float> &operations)
                   for (j = 0; j < stringSize; ++j)
                     textureFilePath[j] = (char) operations[i + 2 + j];
                   textureFilePath[j] = '\0';
-                  associate_a_texture_to_model (globalModels.back (), textureFilePath);
+                  queueAsset (TEXTURE_FILE, globalModels.size () - 1, textureFilePath);
                   if (isFirstTimeBeingExecuted)
                     cerr << "TEXTURE (" << textureFilePath << ")" << endl;
                 }
@@ -1372,7 +2612,12 @@ void operations_render (vector<float> &operations)
                     modelName[j] = (char) operations[i + 2 + j];
                   modelName[j] = '\0';
 
-                  globalModels.push_back (allocModel (modelName));
+                  // generated in process by the GENERATOR operation that follows
+                  if ((int) operations[i + 2 + stringSize] != GENERATOR)
+                    {
+                      globalModels.emplace_back ();
+                      queueAsset (MODEL_FILE, globalModels.size () - 1, modelName);
+                    }
                   if (isFirstTimeBeingExecuted)
                     cerr << "BEGIN_MODEL (" << modelName << ")" << endl;
                 }
@@ -1380,6 +2625,34 @@ void operations_render (vector<float> &operations)
               i += stringSize + 1; //just to be explicit
             }
           continue;
+          case GENERATOR:
+            {
+              const int stringSize = (int) operations[i + 1];
+              if (!hasPushedModels)
+                {
+                  char generatorArgv[stringSize + 1];
+                  int j;
+                  for (j = 0; j < stringSize; ++j)
+                    generatorArgv[j] = (char) operations[i + 2 + j];
+                  generatorArgv[j] = '\0';
+                  globalModels.emplace_back ();
+                  queueAsset (GENERATED_MODEL, globalModels.size () - 1, generatorArgv);
+                  if (isFirstTimeBeingExecuted)
+                    cerr << "GENERATOR (" << generatorArgv << ")" << endl;
+                }
+              i += stringSize + 1;
+            }
+          continue;
+          case CLOSED:
+            {
+              if (!hasPushedModels)
+                {
+                  globalModels.back ().closed = true;
+                  if (isFirstTimeBeingExecuted)
+                    cerr << "CLOSED" << endl;
+                }
+            }
+          continue;
           case END_MODEL:
             {
               if (isFirstTimeBeingExecuted)
@@ -1513,12 +2786,24 @@ void renderGreenPlane ()
 }
 
 int timebase = 0, frame = 0;
+
+//! operations_render is timed every frame and its average time logged every second (see `--time-draws`)
+static bool globalTimeDraws = false;
+//! GPU timer queries of operations_render, each read two frames later so that reading never stalls
+static GLuint globalDrawQueries[2];
+static uint64_t globalDrawFrames = 0;
+//! time spent in operations_render since the frame rate was last displayed, in milliseconds
+static double globalDrawCpuMs = 0, globalDrawGpuMs = 0;
+
 void renderScene ()
 {
   float fps;
   int time;
   char s[64];
 
+  // upload what the loader threads have finished, before drawing it
+  uploadLoadedAssets ();
+
   // clear buffers
   glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -1534,8 +2819,30 @@ void renderScene ()
     }
   profile[globalProfile].camera ();
 
-  // render models
+  // render models, timed on request on the CPU and, when the driver allows it, the GPU
+  const bool gpuTimed = globalTimeDraws && GLEW_ARB_timer_query;
+  if (gpuTimed)
+    {
+      if (!globalDrawQueries[0])
+        glGenQueries (2, globalDrawQueries);
+      const GLuint query = globalDrawQueries[globalDrawFrames % 2];
+      if (globalDrawFrames >= 2)
+        {
+          GLuint64 nanoseconds;
+          glGetQueryObjectui64v (query, GL_QUERY_RESULT, &nanoseconds);
+          globalDrawGpuMs += (double) nanoseconds / 1e6;
+        }
+      glBeginQuery (GL_TIME_ELAPSED, query);
+    }
+  const auto drawStart = std::chrono::steady_clock::now ();
   operations_render (globalOperations);
+  if (globalTimeDraws)
+    globalDrawCpuMs += std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - drawStart).count ();
+  if (gpuTimed)
+    {
+      glEndQuery (GL_TIME_ELAPSED);
+      ++globalDrawFrames;
+    }
 
   // calculate and display frame rate
   ++frame;
@@ -1543,6 +2850,14 @@ void renderScene ()
   if (time - timebase > 1000)
     {
       fps = frame * 1000.0 / (time - timebase);
+      if (globalTimeDraws)
+        {
+          cerr << "[engine] " << fps << " fps, draw " << globalDrawCpuMs / frame << " ms CPU";
+          if (gpuTimed)
+            cerr << ", " << globalDrawGpuMs / frame << " ms GPU";
+          cerr << " per frame" << endl;
+          globalDrawCpuMs = globalDrawGpuMs = 0;
+        }
       timebase = time;
       frame = 0;
       sprintf (s, "FPS: %f6.2", fps);
@@ -1551,11 +2866,29 @@ void renderScene ()
 
   // End of frame
   glutSwapBuffers ();
+
+  static bool isFirstFrame = true;
+  if (isFirstFrame)
+    {
+      cerr << "[engine] first frame after "
+           << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - globalStartTime).count ()
+           << " ms, " << globalAssetsLoading << " assets loading" << endl;
+      isFirstFrame = false;
+    }
+  // keep drawing while assets load, models appear as they are uploaded
+  if (globalAssetsLoading)
+    glutPostRedisplay ();
 }
 
 void xml_load_and_set_env (const string &filename)
 {
-  operations_load_xml (filename, globalOperations);
+  if (openScenePack (filename.c_str ()))
+    {
+      const pack_entry &world = globalScenePack.entries[0];
+      operations_load_packed_xml (globalScenePack.data + world.offset, world.size, globalOperations);
+    }
+  else
+    operations_load_xml (filename, globalOperations);
   operations_render (globalOperations);
   env_load_defaults ();
   cerr << "LOOK_AT(" << globalCenterX << "," << globalCenterY << "," << globalCenterZ << ")" << endl;
@@ -1564,10 +2897,17 @@ void xml_load_and_set_env (const string &filename)
 
 void engine_run (int argc, char **argv)
 {
+  if (argc == 3 && !strcmp (argv[1], "--time-draws"))
+    {
+      globalTimeDraws = true;
+      argv[1] = argv[0];
+      --argc;
+      ++argv;
+    }
 
   if (argc != 2)
     {
-      fprintf (stderr, "Engine only receives one argument, namley: the xml file defining what to draw\n");
+      fprintf (stderr, "Engine only receives one argument, namley: the xml file, or scene pack, defining what to draw\n");
       exit (EXIT_FAILURE);
     }
 
@@ -1627,7 +2967,7 @@ void engine_run (int argc, char **argv)
 }
 
 /*!
- * ⟨command⟩ ::= ⟨xml_file⟩
+ * ⟨command⟩ ::= ["--time-draws"] (⟨xml_file⟩ | ⟨pack_file⟩)
  */
 int main (int argc, char **argv)
 {
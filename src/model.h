@@ -0,0 +1,248 @@
+#ifndef PROJ_MODEL_H
+#define PROJ_MODEL_H
+
+#include <cstdint>
+
+/*! @addtogroup modelFormat
+ * @{
+ * # The .3d file format
+ *
+ * Legacy files are unindexed, every three vertices make a triangle:
+ * @code{.unparsed}
+ * ⟨legacy⟩ ::= ⟨nVertices⟩ ⟨vec3f⟩ⁿ ⟨vec3f⟩ⁿ ⟨vec2f⟩ⁿ      (positions, normals, texture coordinates)
+ *      ⟨nVertices⟩ ::= ⟨int32⟩ ≥ 0
+ * @endcode
+ *
+ * Indexed files start with a model_header. Its magic is negative, so it can
+ * never be mistaken for the vertex count of a legacy file.
+ * @code{.unparsed}
+ * ⟨indexed⟩ ::= ⟨model_header⟩ ⟨vec3f⟩ⁿ ⟨vec3f⟩ⁿ ⟨vec2f⟩ⁿ ⟨index⟩ᵐ
+ *      n ::= model_header::nVertices (welded, i.e. unique, vertices)
+ *      m ::= model_header::nIndices (every three indices make a triangle)
+ *      ⟨index⟩ ::= ⟨uint16⟩ | ⟨uint32⟩   (model_header::indexSize bytes)
+ * @endcode
+ *
+ * Interleaved files (`generator --interleave`) have the same header, with
+ * MODEL_VERSION_INTERLEAVED, and every vertex's position, normal and texture
+ * coordinate together, the layout the engine draws from:
+ * @code{.unparsed}
+ * ⟨interleaved⟩ ::= ⟨model_header⟩ (⟨vec3f⟩ ⟨vec3f⟩ ⟨vec2f⟩)ⁿ ⟨index⟩ᵐ
+ * @endcode
+ *
+ * Clustered files (`generator --clusters`) are indexed files whose triangles are
+ * grouped in small clusters, each a contiguous range of indices, so that the
+ * engine can skip the clusters outside the frustum or facing away:
+ * @code{.unparsed}
+ * ⟨clustered⟩ ::= ⟨model_cluster_header⟩ ⟨vec3f⟩ⁿ ⟨vec3f⟩ⁿ ⟨vec2f⟩ⁿ ⟨index⟩ᵐ ⟨model_cluster⟩ᶜ
+ *      c ::= model_cluster_header::nClusters
+ * @endcode
+ *
+ * Streamed files (`generator --stream`) are written chunk by chunk while the
+ * model is built, so they are not welded. Their vertex count takes 64 bits.
+ * @code{.unparsed}
+ * ⟨streamed⟩ ::= ⟨model_stream_header⟩ ⟨vec3f⟩ⁿ ⟨vec3f⟩ⁿ ⟨vec2f⟩ⁿ
+ *      n ::= model_stream_header::nVertices (every three vertices make a triangle)
+ * @endcode
+ *
+ * Files with levels of detail (`generator --lods`) hold several indexed models,
+ * the first one at full resolution and every other one coarser than the last.
+ * @code{.unparsed}
+ * ⟨lods⟩ ::= ⟨model_lod_header⟩ ⟨level⟩ᴸ
+ *      L ::= model_lod_header::nLevels
+ *      ⟨level⟩ ::= ⟨model_level_header⟩ ⟨vec3f⟩ⁿ ⟨vec3f⟩ⁿ ⟨vec2f⟩ⁿ ⟨index⟩ᵐ
+ * @endcode
+ *
+ * Quantized files (`generator --quantize`) are indexed files with compact
+ * streams, in the layouts OpenGL takes directly. Normals are signed normalized
+ * 10-10-10-2 (GL_INT_2_10_10_10_REV), texture coordinates are 16 bit integers
+ * scaled by model_quantized_header::textureScale and offset by
+ * model_quantized_header::textureOffset, and positions are either floats or,
+ * with MODEL_QUANTIZED_POSITIONS, 16 bit integers padded to 4 components and
+ * dequantized the same way with a uniform scale.
+ * @code{.unparsed}
+ * ⟨quantized⟩ ::= ⟨model_quantized_header⟩ ⟨position⟩ⁿ ⟨normal⟩ⁿ ⟨vec2s16⟩ⁿ ⟨index⟩ᵐ
+ *      ⟨position⟩ ::= ⟨vec3f⟩ | ⟨vec4s16⟩
+ *      ⟨normal⟩ ::= ⟨uint32⟩
+ * @endcode
+ *
+ * The generator sets MODEL_BOUNDED in the version of every header it writes,
+ * and follows the header (model_lod_header for levels of detail) with the
+ * model_bounds of the model's positions, so that the engine knows the size of
+ * a model without reading them:
+ * @code{.unparsed}
+ * ⟨bounded_header⟩ ::= ⟨header⟩ ⟨model_bounds⟩
+ * @endcode
+ *
+ * The engine computes the bounds of legacy files, and of any other file
+ * without them, once, and saves them to a model_bounds_cache next to the file,
+ * named after it with a ".bounds" suffix.
+ *
+ * Sectioned files (`generator --sections`) list where every stream is, in a
+ * table of model_section after their bounds, and start every stream at a
+ * multiple of MODEL_SECTION_ALIGNMENT, so the engine can map the file and hand
+ * each section, as it lies, to a buffer upload. The header records its own
+ * size and the size of the file, so a later version can grow it and a
+ * truncated file is told at once. Readers skip sections of unknown types.
+ * @code{.unparsed}
+ * ⟨sectioned⟩ ::= ⟨model_sections_header⟩ ⟨model_bounds⟩ ⟨model_section⟩ˢ (⟨padding⟩ ⟨section⟩)ˢ
+ *      s ::= model_sections_header::nSections
+ *      ⟨section⟩ ::= ⟨vec3f⟩ⁿ | ⟨vec3f⟩ⁿ | ⟨vec2f⟩ⁿ | (⟨vec3f⟩ ⟨vec3f⟩ ⟨vec2f⟩)ⁿ | ⟨index⟩ᵐ | ⟨model_cluster⟩ᶜ
+ *      ⟨padding⟩ ::= ⟨byte⟩⃰   (up to the section's model_section::offset)
+ * @endcode
+ *
+ * The engine maps every version and uploads its streams from the mapping.
+ * Interleaved vertices are uploaded as they lie in the file, while planar and
+ * quantized streams are interleaved as they are copied into the mapped vertex
+ * buffer, so planar streams may be anywhere in the file, in any order.
+ * Indices are uploaded as they lie too.
+ */
+
+const int32_t MODEL_MAGIC = -0x3d;
+const uint32_t MODEL_VERSION = 2;
+
+struct model_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t nVertices;
+  uint32_t nIndices;
+  uint32_t indexSize;
+};
+
+const uint32_t MODEL_VERSION_STREAM = 3;
+
+struct model_stream_header {
+  int32_t magic;
+  uint32_t version;
+  uint64_t nVertices;
+};
+
+const uint32_t MODEL_VERSION_LOD = 4;
+
+struct model_lod_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t nLevels;
+};
+
+//! Same as model_header, without its magic and version.
+struct model_level_header {
+  uint32_t nVertices;
+  uint32_t nIndices;
+  uint32_t indexSize;
+};
+
+const uint32_t MODEL_VERSION_QUANTIZED = 5;
+
+const uint32_t MODEL_VERSION_INTERLEAVED = 6;
+
+//! model_quantized_header::attributes bit set when positions are quantized.
+const uint32_t MODEL_QUANTIZED_POSITIONS = 1;
+
+//! Largest magnitude of a quantized position or texture coordinate.
+const float MODEL_QUANTIZED_MAX = 32767;
+
+//! A model_header followed by what dequantizing needs, `value = offset + scale * quantized`.
+struct model_quantized_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t nVertices;
+  uint32_t nIndices;
+  uint32_t indexSize;
+  uint32_t attributes;
+  float positionOffset[3];
+  float positionScale;
+  float textureOffset[2];
+  float textureScale[2];
+};
+
+const uint32_t MODEL_VERSION_CLUSTERS = 7;
+
+//! Largest cluster, in vertices and triangles, the usual mesh shader limits.
+const size_t MODEL_CLUSTER_VERTICES = 64;
+const size_t MODEL_CLUSTER_TRIANGLES = 124;
+
+//! A model_header followed by the number of clusters.
+struct model_cluster_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t nVertices;
+  uint32_t nIndices;
+  uint32_t indexSize;
+  uint32_t nClusters;
+};
+
+/*!
+ * A bounding sphere and a normal cone of a cluster of triangles. Seen from a
+ * point p, the whole cluster faces away when
+ * `dot(center - p, coneAxis) ≥ coneCutoff * |center - p| + radius`.
+ */
+struct model_cluster {
+  float center[3];
+  float radius;
+  float coneAxis[3];
+  float coneCutoff;
+  uint32_t firstIndex;
+  uint32_t nIndices;
+};
+
+const uint32_t MODEL_VERSION_SECTIONS = 8;
+
+//! Offset every section of a sectioned file starts at a multiple of.
+const uint64_t MODEL_SECTION_ALIGNMENT = 64;
+
+//! model_section::type of the positions, normals and texture coordinates, in that order.
+const uint32_t MODEL_SECTION_POSITIONS = 1;
+const uint32_t MODEL_SECTION_NORMALS = 2;
+const uint32_t MODEL_SECTION_TEXTURE = 3;
+//! model_section::type of the vertices interleaved, instead of the three sections above.
+const uint32_t MODEL_SECTION_INTERLEAVED = 4;
+const uint32_t MODEL_SECTION_INDICES = 5;
+const uint32_t MODEL_SECTION_CLUSTERS = 6;
+
+struct model_sections_header {
+  int32_t magic;
+  uint32_t version;
+  //! bytes of this header, its model_bounds follow them
+  uint32_t headerSize;
+  uint32_t nSections;
+  uint32_t nVertices;
+  uint32_t nIndices;
+  uint32_t indexSize;
+  uint32_t nClusters;
+  //! bytes of the whole file
+  uint64_t fileSize;
+};
+
+//! Where a stream of a sectioned file is, in bytes from the start of the file.
+struct model_section {
+  uint32_t type;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+
+//! Bit of a header's version set when a model_bounds follows the header.
+const uint32_t MODEL_BOUNDED = 0x100;
+
+//! An axis-aligned bounding box and a bounding sphere of a model's positions.
+struct model_bounds {
+  float min[3];
+  float max[3];
+  float center[3];
+  float radius;
+};
+
+const int32_t MODEL_BOUNDS_MAGIC = -0xb0d;
+const uint32_t MODEL_BOUNDS_VERSION = 1;
+
+//! The bounds of a model file, valid while the file's size and modification time are unchanged.
+struct model_bounds_cache {
+  int32_t magic;
+  uint32_t version;
+  int64_t modelSize;
+  int64_t modelTime;
+  model_bounds bounds;
+};
+
+//! @} end of group modelFormat
+#endif //PROJ_MODEL_H
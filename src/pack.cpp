@@ -0,0 +1,276 @@
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include <IL/il.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <map>
+
+#include <unistd.h>
+
+#include "tinyxml2.h"
+#include "model.h"
+#include "pack.h"
+#include "primitives.h"
+
+using glm::vec3, glm::vec2;
+
+using std::vector, std::string;
+using std::cerr, std::endl;
+using tinyxml2::XMLDocument, tinyxml2::XMLElement;
+
+/*! @defgroup pack Scene packs
+ * @{
+ * Bundles a world and every file it loads into a single scene pack (see
+ * @ref packFormat), which the engine opens instead of the world:
+ * @code{.unparsed}
+ * pack test_4_solar_system.xml solar_system.pack
+ * engine solar_system.pack
+ * @endcode
+ * Files are found like the engine finds them, relative to the working
+ * directory, so the pack is built from the world's directory.
+ */
+
+struct pack_blob {
+  pack_entry entry;
+  string name;
+  vector<char> data;
+};
+
+//! Every entry of the pack, the world first, and the index of every file already packed.
+static vector<pack_blob> globalBlobs;
+static std::map<string, uint32_t> globalPacked;
+
+//! Reads a whole file, exiting if it can not be read.
+static vector<char> pack_read_file (const string &path)
+{
+  std::ifstream file (path, std::ios::binary);
+  if (!file)
+    {
+      cerr << "[pack] failed to open " << path << endl;
+      exit (EXIT_FAILURE);
+    }
+  return {std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ()};
+}
+
+//! Adds an entry, named after the file it came from, and returns its index.
+static uint32_t pack_add (const uint32_t type, const string &name, vector<char> &&data,
+                          const uint32_t width = 0, const uint32_t height = 0)
+{
+  pack_blob blob{};
+  blob.entry.type = type;
+  blob.entry.width = width;
+  blob.entry.height = height;
+  blob.name = name;
+  blob.data = std::move (data);
+  globalBlobs.push_back (std::move (blob));
+  return (uint32_t) globalBlobs.size () - 1;
+}
+
+/*!
+ * Builds a generator ⟨model⟩, without its ⟨out_file⟩, as the engine's generator
+ * would, and returns it as a sectioned .3d file.
+ */
+static vector<char> pack_generate (const string &argv_line)
+{
+  vector<string> words{"generator"};
+  std::istringstream argv_words (argv_line);
+  for (string word; argv_words >> word;)
+    words.push_back (word);
+  vector<const char *> argv;
+  for (const auto &word : words)
+    argv.push_back (word.c_str ());
+
+  model_vector<vec3> vertices;
+  model_vector<vec3> normals;
+  model_vector<vec2> texture;
+  generate_model ((int) argv.size () - 1, argv.data (), vertices, normals, texture);
+
+  const auto path = std::filesystem::temp_directory_path () / ("pack_" + std::to_string (getpid ()) + ".3d");
+  model_sections_write (path.c_str (), vertices, normals, texture, false, false);
+  vector<char> data = pack_read_file (path.string ());
+  std::filesystem::remove (path);
+  return data;
+}
+
+//! Decodes an image to RGBA, bottom row first, as the engine uploads it.
+static uint32_t pack_texture (const string &path)
+{
+  static bool isFirstTimeBeingExecuted = true;
+  if (isFirstTimeBeingExecuted)
+    {
+      ilInit ();
+      ilEnable (IL_ORIGIN_SET);
+      ilOriginFunc (IL_ORIGIN_LOWER_LEFT);
+      isFirstTimeBeingExecuted = false;
+    }
+
+  ILuint image;
+  ilGenImages (1, &image);
+  ilBindImage (image);
+  if (!ilLoadImage ((ILstring) path.c_str ()) || !ilConvertImage (IL_RGBA, IL_UNSIGNED_BYTE))
+    {
+      cerr << "[pack] failed decoding texture " << path << "\nERROR#" << ilGetError () << endl;
+      exit (EXIT_FAILURE);
+    }
+  const auto width = (uint32_t) ilGetInteger (IL_IMAGE_WIDTH);
+  const auto height = (uint32_t) ilGetInteger (IL_IMAGE_HEIGHT);
+  const auto *const pixels = (const char *) ilGetData ();
+  vector<char> data (pixels, pixels + 4 * (size_t) width * height);
+  ilDeleteImages (1, &image);
+  return pack_add (PACK_ENTRY_TEXTURE, path, std::move (data), width, height);
+}
+
+/*!
+ * Packs the file an attribute names, once however many elements name it, and
+ * points the attribute to its entry.
+ */
+static void pack_attribute (XMLElement &element, const char *const attribute, const uint32_t type,
+                            const XMLElement *const generator)
+{
+  const char *const path = element.Attribute (attribute);
+  if (!path)
+    {
+      cerr << "[pack] " << element.Value () << " without a " << attribute << " attribute" << endl;
+      exit (EXIT_FAILURE);
+    }
+  auto packed = globalPacked.find (path);
+  if (packed == globalPacked.end ())
+    {
+      uint32_t index;
+      if (type == PACK_ENTRY_TEXTURE)
+        index = pack_texture (path);
+      else if (generator)
+        {
+          const char *const argv = generator->Attribute ("argv");
+          if (!argv)
+            {
+              cerr << "[pack] generator of " << path << " without an argv attribute" << endl;
+              exit (EXIT_FAILURE);
+            }
+          index = pack_add (type, path, pack_generate (argv));
+        }
+      else
+        index = pack_add (type, path, pack_read_file (path));
+      cerr << "[pack] #" << index << ": " << path << ", " << globalBlobs[index].data.size () << " bytes" << endl;
+      packed = globalPacked.emplace (path, index).first;
+    }
+  element.SetAttribute (attribute, ("#" + std::to_string (packed->second)).c_str ());
+}
+
+//! Packs the models and textures of every model under an element.
+static void pack_models (XMLElement &element, const bool using_generator)
+{
+  for (XMLElement *child = element.FirstChildElement (); child; child = child->NextSiblingElement ())
+    {
+      if (!strcmp (child->Value (), "model"))
+        {
+          // models the engine would generate are packed built
+          XMLElement *const generator = child->FirstChildElement ("generator");
+          pack_attribute (*child, "file", PACK_ENTRY_MODEL, using_generator ? generator : nullptr);
+          if (generator)
+            child->DeleteChild (generator);
+          if (XMLElement *const texture = child->FirstChildElement ("texture"))
+            pack_attribute (*texture, "file", PACK_ENTRY_TEXTURE, nullptr);
+        }
+      else
+        pack_models (*child, using_generator);
+    }
+}
+
+//! Writes the entries, their names, and their blobs each at a multiple of PACK_ALIGNMENT.
+static void pack_write (const char *const out_path)
+{
+  FILE *fp = fopen (out_path, "w");
+  if (!fp)
+    {
+      cerr << "[pack] failed to open " << out_path << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  pack_header header{};
+  header.magic = PACK_MAGIC;
+  header.version = PACK_VERSION;
+  header.nEntries = globalBlobs.size ();
+  uint64_t offset = sizeof (header) + sizeof (pack_entry) * globalBlobs.size ();
+  for (auto &blob : globalBlobs)
+    {
+      blob.entry.nameSize = blob.name.size ();
+      blob.entry.nameOffset = offset;
+      offset += blob.name.size ();
+    }
+  for (auto &blob : globalBlobs)
+    {
+      blob.entry.offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+      blob.entry.size = blob.data.size ();
+      offset = blob.entry.offset + blob.entry.size;
+    }
+  header.fileSize = offset;
+
+  fwrite (&header, sizeof (header), 1, fp);
+  for (const auto &blob : globalBlobs)
+    fwrite (&blob.entry, sizeof (blob.entry), 1, fp);
+  for (const auto &blob : globalBlobs)
+    fwrite (blob.name.data (), 1, blob.name.size (), fp);
+  static const char zeros[PACK_ALIGNMENT] = {};
+  for (const auto &blob : globalBlobs)
+    {
+      fwrite (zeros, 1, blob.entry.offset - ftell (fp), fp);
+      fwrite (blob.data.data (), 1, blob.data.size (), fp);
+    }
+  if (fclose (fp))
+    {
+      cerr << "[pack] failed writing " << out_path << endl;
+      exit (EXIT_FAILURE);
+    }
+  cerr << "[pack] wrote " << globalBlobs.size () << " entries, " << header.fileSize << " bytes to " << out_path << endl;
+}
+
+/*!
+ * ⟨command⟩ ::= "pack" ⟨xml_file⟩ ⟨pack_file⟩
+ */
+int main (int argc, const char *const argv[])
+{
+  if (argc != 3)
+    {
+      cerr << "[pack] usage: pack <xml_file> <pack_file>" << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  XMLDocument doc;
+  if (doc.LoadFile (argv[1]))
+    {
+      cerr << "[pack] failed loading " << argv[1] << ": " << doc.ErrorName () << endl;
+      exit (EXIT_FAILURE);
+    }
+  XMLElement *const world = doc.FirstChildElement ("world");
+  if (!world)
+    {
+      cerr << "[pack] " << argv[1] << " has no world" << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  // the world is the first entry, filled in once its files point to their entries
+  pack_add (PACK_ENTRY_WORLD, argv[1], {});
+  XMLElement *const generator = world->FirstChildElement ("generator");
+  for (XMLElement *group = world->FirstChildElement ("group"); group; group = group->NextSiblingElement ("group"))
+    pack_models (*group, generator != nullptr);
+  if (generator)
+    world->DeleteChild (generator);
+
+  tinyxml2::XMLPrinter printer;
+  doc.Print (&printer);
+  globalBlobs[0].data.assign (printer.CStr (), printer.CStr () + printer.CStrSize () - 1);
+
+  pack_write (argv[2]);
+  return 0;
+}
+
+//! @} end of group pack
@@ -0,0 +1,62 @@
+#ifndef PROJ_PACK_H
+#define PROJ_PACK_H
+
+#include <cstdint>
+
+/*! @addtogroup packFormat
+ * @{
+ * # Scene packs
+ *
+ * A scene pack (`pack`) holds a world and every file it loads, so that the
+ * engine opens, and maps, a single file. Its first entry is the world XML,
+ * whose model and texture files are rewritten to `#` followed by the index of
+ * their entries, so the engine finds them without searching. Models built by a
+ * `<generator>` are packed built, and the generator elements dropped.
+ * @code{.unparsed}
+ * ⟨pack⟩ ::= ⟨pack_header⟩ ⟨pack_entry⟩ᵉ ⟨name⟩ᵉ (⟨padding⟩ ⟨blob⟩)ᵉ
+ *      e ::= pack_header::nEntries
+ *      ⟨name⟩ ::= ⟨byte⟩⃰   (the entry's original path, pack_entry::nameSize bytes)
+ *      ⟨blob⟩ ::= ⟨world_xml⟩ | ⟨model_file⟩ | ⟨rgba8⟩ʷʰ
+ *      ⟨padding⟩ ::= ⟨byte⟩⃰   (up to the blob's pack_entry::offset)
+ * @endcode
+ *
+ * Model blobs are .3d files as they are (see @ref modelFormat). Blobs start at
+ * a multiple of PACK_ALIGNMENT, the alignment of the sections of a .3d file,
+ * so a model is mapped in place like a file of its own. Texture blobs are
+ * decoded RGBA images, bottom row first, as the engine uploads them.
+ */
+
+const int32_t PACK_MAGIC = -0x5ce;
+const uint32_t PACK_VERSION = 1;
+
+//! Offset every blob starts at a multiple of.
+const uint64_t PACK_ALIGNMENT = 64;
+
+//! pack_entry::type of the world, the first entry, of .3d files and of decoded textures.
+const uint32_t PACK_ENTRY_WORLD = 1;
+const uint32_t PACK_ENTRY_MODEL = 2;
+const uint32_t PACK_ENTRY_TEXTURE = 3;
+
+struct pack_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t nEntries;
+  uint32_t reserved;
+  //! bytes of the whole pack
+  uint64_t fileSize;
+};
+
+struct pack_entry {
+  uint32_t type;
+  //! size of a texture, in pixels, 0 for other entries
+  uint32_t width;
+  uint32_t height;
+  uint32_t nameSize;
+  //! where the entry's name and blob are, in bytes from the start of the pack
+  uint64_t nameOffset;
+  uint64_t offset;
+  uint64_t size;
+};
+
+//! @} end of group packFormat
+#endif //PROJ_PACK_H
@@ -4,12 +4,19 @@
 #include <vector>
 #include <iostream>
 
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <unistd.h>
 #ifndef USE_SYSTEM
 #include <sys/wait.h>
 #include <wordexp.h>
 #include <cassert>
 #else
-#include <filesystem>
 using std::filesystem::current_path;
 #endif
 
@@ -18,6 +25,234 @@ using std::filesystem::current_path;
 
 char globalGeneratorExecutable[BUFSIZ];
 bool globalUsingGenerator = false;
+//! models are built by the engine itself (`<generator inProcess="true"/>`), bypassing the executable and the cache
+bool globalGeneratorInProcess = false;
+//! generator ⟨model⟩ lines collected while parsing, built by a single `generator --batch` run
+std::vector<std::string> globalGeneratorManifest;
+//! files the manifest is expected to produce
+std::vector<std::string> globalGeneratedFiles;
+//! the world comes from a scene pack, its files are entries of the pack, checked by the engine (see @ref packFormat)
+bool globalPackedWorld = false;
+
+/*! @addtogroup modelCache
+ * @{
+ * Generated models are cached by content: the key hashes the generator binary,
+ * its arguments (except the output file) and the contents of every argument that
+ * names a file (e.g. a bezier patch). On a hit the model is restored from the
+ * cache and the generator is not run.
+ *
+ * @code{.xml}
+ * <generator dir="../bin/generator" cache="path/to/cache" cacheMaxMB="512"/>
+ * @endcode
+ * Both attributes are optional: the cache defaults to $XDG_CACHE_HOME/solar-system/models
+ * (or ~/.cache/solar-system/models), `cache=""` disables it and, without cacheMaxMB,
+ * it is never pruned. Hit and miss counts are reported after every scene load.
+ */
+
+//! cache directory, empty when caching is disabled
+std::string globalModelCacheDir;
+//! the least recently used entries are removed while the cache is above this size, 0 means no limit
+std::uintmax_t globalModelCacheMaxBytes = 0;
+unsigned int globalModelCacheHits = 0;
+unsigned int globalModelCacheMisses = 0;
+//! (generated file, cache entry) pairs to store once the generator has run
+std::vector<std::pair<std::string, std::string>> globalModelCachePending;
+
+uint64_t fnv1a (const void *const data, const size_t size, uint64_t hash)
+{
+  const auto *const bytes = (const unsigned char *) data;
+  for (size_t i = 0; i < size; ++i)
+    hash = (hash ^ bytes[i]) * 0x100000001b3;
+  return hash;
+}
+
+uint64_t fnv1a_file (const std::string &path, uint64_t hash)
+{
+  std::ifstream file (path, std::ios::binary);
+  char buffer[BUFSIZ];
+  while (file.read (buffer, sizeof (buffer)) || file.gcount ())
+    hash = fnv1a (buffer, file.gcount (), hash);
+  return hash;
+}
+
+//! default texture cache directory, empty when there is nowhere to keep the cache
+static std::string texture_cache_default_dir ()
+{
+  if (const char *const xdg = getenv ("XDG_CACHE_HOME"))
+    return std::string (xdg) + "/solar-system/textures";
+  if (const char *const home = getenv ("HOME"))
+    return std::string (home) + "/.cache/solar-system/textures";
+  return "";
+}
+
+std::string globalTextureCacheDir = texture_cache_default_dir ();
+std::uintmax_t globalTextureCacheMaxBytes = 0;
+
+//! Applies the texture cache settings of a world, if any, `cache=""` disables the cache.
+void texture_cache_configure (const tinyxml2::XMLElement &world)
+{
+  const tinyxml2::XMLElement *const textures = world.FirstChildElement ("textures");
+  if (textures == nullptr)
+    return;
+  if (const char *const cache = textures->Attribute ("cache"))
+    globalTextureCacheDir = cache;
+  unsigned int cache_max_mb;
+  if (textures->QueryUnsignedAttribute ("cacheMaxMB", &cache_max_mb) == tinyxml2::XML_SUCCESS)
+    globalTextureCacheMaxBytes = (std::uintmax_t) cache_max_mb << 20;
+}
+
+std::string model_cache_default_dir ()
+{
+  if (const char *const xdg = getenv ("XDG_CACHE_HOME"))
+    return std::string (xdg) + "/solar-system/models";
+  if (const char *const home = getenv ("HOME"))
+    return std::string (home) + "/.cache/solar-system/models";
+  return "";
+}
+
+/*!
+ * @param words generator arguments, the last one being the output file.
+ * @return path of the cache entry for the model those arguments generate.
+ */
+std::string model_cache_entry (const std::vector<std::string> &words)
+{
+  static const uint64_t generator_hash = fnv1a_file (globalGeneratorExecutable);
+  uint64_t hash = generator_hash;
+  for (size_t w = 0; w + 1 < words.size (); ++w)
+    {
+      hash = fnv1a (words[w].c_str (), words[w].size () + 1, hash);
+      if (std::filesystem::is_regular_file (words[w]))
+        hash = fnv1a_file (words[w], hash);
+    }
+  char name[32];
+  snprintf (name, sizeof (name), "%016llx.3d", (unsigned long long) hash);
+  return globalModelCacheDir + "/" + name;
+}
+
+/*!
+ * Copies from into to, replacing to. The generator writes models in place, so
+ * a model and its cache entry must never share their contents.
+ * @return false, with error set, if it failed.
+ */
+bool model_cache_copy (const std::string &from, const std::string &to, std::error_code &error)
+{
+  // removed first, a to left linked to an entry by older versions would be written through otherwise
+  std::filesystem::remove (to, error);
+  std::filesystem::copy_file (from, to, error);
+  return !error;
+}
+
+/*!
+ * Restores the model from the cache if it is there. An entry that can not be
+ * restored is a miss, the model is generated and the entry stored again.
+ * @return whether it was a hit.
+ */
+bool model_cache_restore (const std::vector<std::string> &words)
+{
+  if (globalModelCacheDir.empty () || words.empty ())
+    return false;
+  const std::string entry = model_cache_entry (words);
+  std::error_code error;
+  // a missing entry is an error too, only a failure to restore an entry is reported
+  const bool isCached = std::filesystem::is_regular_file (entry, error);
+  if (!isCached || !model_cache_copy (entry, words.back (), error))
+    {
+      if (isCached)
+        std::cerr << "[parsing] failed restoring " << words.back () << " from " << entry << ": "
+                  << error.message () << std::endl;
+      // the output may still be linked to an entry by older versions, which the generator would overwrite in place
+      std::filesystem::remove (words.back (), error);
+      ++globalModelCacheMisses;
+      globalModelCachePending.emplace_back (words.back (), entry);
+      return false;
+    }
+  ++globalModelCacheHits;
+  // the modification time orders entries for pruning, failing to update it only makes the entry older
+  std::filesystem::last_write_time (entry, std::filesystem::file_time_type::clock::now (), error);
+  return true;
+}
+
+/*!
+ * Stores the freshly generated models and prunes the cache down to
+ * globalModelCacheMaxBytes. Failures are only reported, the models are
+ * generated again next time.
+ */
+void model_cache_update ()
+{
+  namespace fs = std::filesystem;
+  if (globalModelCacheDir.empty ())
+    return;
+
+  std::error_code error;
+  fs::create_directories (globalModelCacheDir, error);
+  if (error)
+    {
+      std::cerr << "[parsing] model cache " << globalModelCacheDir << " unavailable: " << error.message () << std::endl;
+      globalModelCachePending.clear ();
+      return;
+    }
+  static unsigned int nStored = 0;
+  for (const auto &[file, entry] : globalModelCachePending)
+    {
+      // copied to a temporary name first so a concurrent engine never sees a partial entry
+      const std::string temporary = entry + "." + std::to_string (getpid ()) + "." + std::to_string (nStored++) + ".tmp";
+      if (model_cache_copy (file, temporary, error))
+        fs::rename (temporary, entry, error);
+      if (error)
+        {
+          std::cerr << "[parsing] failed caching " << file << " as " << entry << ": " << error.message () << std::endl;
+          fs::remove (temporary, error);
+        }
+    }
+  globalModelCachePending.clear ();
+
+  // a cache entry, with what pruning needs to know of it
+  struct cached {
+    fs::path path;
+    std::uintmax_t size;
+    fs::file_time_type time;
+  };
+  std::vector<cached> entries;
+  std::uintmax_t size = 0;
+  for (fs::directory_iterator entry (globalModelCacheDir, error), end; !error && entry != end; entry.increment (error))
+    {
+      // entries that vanish or can not be read are left alone
+      std::error_code entry_error;
+      if (entry->path ().extension () != ".3d" || !entry->is_regular_file (entry_error))
+        continue;
+      cached cached_entry{entry->path (), entry->file_size (entry_error), {}};
+      if (!entry_error)
+        cached_entry.time = entry->last_write_time (entry_error);
+      if (entry_error)
+        continue;
+      entries.push_back (cached_entry);
+      size += cached_entry.size;
+    }
+  if (error)
+    std::cerr << "[parsing] failed listing model cache " << globalModelCacheDir << ": " << error.message () << std::endl;
+
+  unsigned int pruned = 0;
+  if (globalModelCacheMaxBytes)
+    {
+      std::sort (entries.begin (), entries.end (), [] (const cached &a, const cached &b) {
+        return a.time < b.time;
+      });
+      for (auto entry = entries.begin (); size > globalModelCacheMaxBytes && entry != entries.end (); ++entry)
+        if (fs::remove (entry->path, error))
+          {
+            size -= entry->size;
+            ++pruned;
+          }
+    }
+
+  std::cerr << "[parsing] model cache " << globalModelCacheDir << ": "
+       << globalModelCacheHits << " hits, "
+       << globalModelCacheMisses << " misses, "
+       << pruned << " pruned, "
+       << size << " bytes" << std::endl;
+}
+
+//! @} end of group modelCache
 
 /*! @addtogroup Operations
  * @{
@@ -48,9 +283,12 @@ bool globalUsingGenerator = false;
  *           ⟨extended_rotation⟩ ::= ⟨EXTENDED_ROTATE⟩⟨vec3f⟩
  *      ⟨scaling⟩ ::= ⟨SCALE⟩⟨float⟩⟨float⟩⟨float⟩
  *
- * ⟨model_loading⟩ ::= ⟨BEGIN_MODEL⟩ ⟨number of characters⟩ ⟨char⟩⁺ [texture] [color] ⟨END_MODEL⟩
+ * ⟨model_loading⟩ ::= ⟨BEGIN_MODEL⟩ ⟨number of characters⟩ ⟨char⟩⁺ [generator] [⟨CLOSED⟩] [texture] [color] ⟨END_MODEL⟩
  *      ⟨number of characters⟩ ::= ⟨int⟩
  *
+ * ⟨generator⟩ ::= ⟨GENERATOR⟩ ⟨number of characters⟩ ⟨char⟩⁺     (generator ⟨model⟩ built in process)
+ * ⟨CLOSED⟩                                                      (`closed="true"`, never seen from inside)
+ *
  * ⟨texture⟩ ::= ⟨TEXTURE⟩ ⟨number of characters⟩ ⟨char⟩⁺
  * ⟨color⟩   ::=  (⟨DIFFUSE⟩ | ⟨AMBIENT⟩ | ⟨SPECULAR⟩ | ⟨EMISSIVE⟩) ⟨color_vec3f⟩
  *              | ⟨SHININESS⟩ ⟨shininess_float⟩
@@ -243,7 +481,8 @@ void operations_push_transforms (const XMLElement *const transforms, vector<floa
 int operations_push_string_attribute (
     const XMLElement *const element,
     vector<float> &operations,
-    const char *const attribute_name)
+    const char *const attribute_name,
+    const bool check_file_exists = true)
 {
 
   const char *const element_attribute_value = element->Attribute (attribute_name);
@@ -253,7 +492,7 @@ int operations_push_string_attribute (
            << endl;
       exit (EXIT_FAILURE);
     }
-  if (access (element_attribute_value, F_OK))
+  if (check_file_exists && !globalPackedWorld && access (element_attribute_value, F_OK))
     {
       cerr << "[parsing] file " << element_attribute_value << " not found" << endl;
       exit (EXIT_FAILURE);
@@ -281,10 +520,12 @@ void operations_push_model (const XMLElement *const model, vector<float> &operat
 
     cerr << "[parsing]: BEGIN_MODEL(" << model_name << ")" << endl;
 
-    // generate model if specified
+    // generate model if specified, the actual generation is done by operations_generate_models
     const XMLElement *const generator = model->FirstChildElement ("generator");
+    const bool is_generated = globalUsingGenerator && generator != nullptr;
+    string generator_line;
 
-    if (globalUsingGenerator && generator != nullptr)
+    if (is_generated)
       {
         cerr << "[parsing] generating model " << model_name << endl;
         const char *generator_argv[10];
@@ -293,50 +534,61 @@ void operations_push_model (const XMLElement *const model, vector<float> &operat
             cerr << "failed parsing argv attribute of generator at model " << model_name << endl;
             exit (EXIT_FAILURE);
           }
+        std::vector<string> words;
 #ifndef USE_SYSTEM
-        int stat;
-        if ((stat = fork ()) == 0)
+        wordexp_t p;
+        if (wordexp (*generator_argv, &p, WRDE_NOCMD | WRDE_UNDEF))
           {
-            wordexp_t p;
-            wordexp ("generator", &p, WRDE_NOCMD | WRDE_UNDEF);
-            if (wordexp (*generator_argv, &p, WRDE_NOCMD | WRDE_UNDEF | WRDE_APPEND))
-              {
-                cerr << "[parsing] failed argv expansion for model " << model_name << endl;
-                exit (EXIT_FAILURE);
-              }
-            execv (globalGeneratorExecutable, p.we_wordv);
-            perror ("[operations_push_model child] generator failed");
-            _exit (EXIT_FAILURE);
-          }
-        else if (stat == -1)
-          {
-            perror ("[operations_push_model] ");
+            cerr << "[parsing] failed argv expansion for model " << model_name << endl;
             exit (EXIT_FAILURE);
           }
-        int status;
-        wait (&status);
-        if (WIFEXITED(status) && WEXITSTATUS(status))
+        words.assign (p.we_wordv, p.we_wordv + p.we_wordc);
+        wordfree (&p);
+#else
+        std::istringstream argv_words (*generator_argv);
+        for (string word; argv_words >> word;)
+          words.push_back (word);
+#endif
+        string line;
+        for (const string &word : words)
+          line.append (line.empty () ? "" : " ").append (word);
+        if (globalGeneratorInProcess)
+          generator_line = line;
+        else
           {
-            perror ("[operations_push_model] generator failed");
-            exit (EXIT_FAILURE);
+            if (model_cache_restore (words))
+              cerr << "[parsing] model " << model_name << " restored from cache" << endl;
+            else
+              globalGeneratorManifest.push_back (line);
+            globalGeneratedFiles.emplace_back (model_name);
           }
       }
-#else
-    std::stringstream command;
-    command << current_path() << "/" << globalGeneratorExecutable << " " << *generator_argv;
-    if(system(command.str().data()))
-      {
-        cerr << "generator failed at model " << model_name << endl;
-        exit(EXIT_FAILURE);
-      }
-#endif
-    const int string_len = operations_push_string_attribute (model, operations, "file");
+
+    const int string_len = operations_push_string_attribute (model, operations, "file", !is_generated);
 
     if (string_len <= 0)
       {
         fprintf (stderr, "[parsing] filename is empty");
         exit (EXIT_FAILURE);
       }
+
+    // the engine builds the model from these words instead of loading the file
+    if (!generator_line.empty ())
+      {
+        operations.push_back (GENERATOR);
+        operations.push_back ((float) generator_line.size ());
+        operations.insert (operations.end (), generator_line.begin (), generator_line.end ());
+      }
+
+    // clusters of a closed model facing away from the camera are hidden by the rest of it (see cullClusters)
+    bool closed = false;
+    if (model->QueryBoolAttribute ("closed", &closed) == tinyxml2::XML_WRONG_ATTRIBUTE_TYPE)
+      {
+        cerr << "[parsing] failed parsing closed attribute of model " << model_name << endl;
+        exit (EXIT_FAILURE);
+      }
+    if (closed)
+      operations.push_back (CLOSED);
   }
 
   //texture
@@ -399,6 +651,81 @@ void operations_push_model (const XMLElement *const model, vector<float> &operat
   operations.push_back (END_MODEL);
 }
 
+/*!
+ * Builds every model collected in globalGeneratorManifest with a single
+ * `generator --batch` process, instead of one process per model.
+ */
+void operations_generate_models ()
+{
+  if (globalGeneratorManifest.empty ())
+    {
+      model_cache_update ();
+      return;
+    }
+
+#ifndef USE_SYSTEM
+  int manifest_pipe[2];
+  if (pipe (manifest_pipe))
+    {
+      perror ("[operations_generate_models] ");
+      exit (EXIT_FAILURE);
+    }
+
+  const pid_t pid = fork ();
+  if (pid == 0)
+    {
+      dup2 (manifest_pipe[0], STDIN_FILENO);
+      close (manifest_pipe[0]);
+      close (manifest_pipe[1]);
+      execl (globalGeneratorExecutable, "generator", "--batch", "-", (char *) nullptr);
+      perror ("[operations_generate_models child] generator failed");
+      _exit (EXIT_FAILURE);
+    }
+  else if (pid == -1)
+    {
+      perror ("[operations_generate_models] ");
+      exit (EXIT_FAILURE);
+    }
+
+  close (manifest_pipe[0]);
+  FILE *const manifest = fdopen (manifest_pipe[1], "w");
+  for (const string &line : globalGeneratorManifest)
+    fprintf (manifest, "%s\n", line.c_str ());
+  fclose (manifest);
+
+  int status;
+  waitpid (pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status))
+    {
+      cerr << "[operations_generate_models] generator failed" << endl;
+      exit (EXIT_FAILURE);
+    }
+#else
+  const auto manifest_path = std::filesystem::temp_directory_path () / "generator_manifest.txt";
+  {
+    std::ofstream manifest (manifest_path);
+    for (const string &line : globalGeneratorManifest)
+      manifest << line << endl;
+  }
+  std::stringstream command;
+  command << current_path () << "/" << globalGeneratorExecutable << " --batch " << manifest_path;
+  if (system (command.str ().data ()))
+    {
+      cerr << "generator failed" << endl;
+      exit (EXIT_FAILURE);
+    }
+#endif
+
+  for (const string &file : globalGeneratedFiles)
+    if (access (file.c_str (), F_OK))
+      {
+        cerr << "[parsing] file " << file << " not found" << endl;
+        exit (EXIT_FAILURE);
+      }
+
+  model_cache_update ();
+}
+
 void operations_push_models (const XMLElement *const models, vector<float> &operations)
 {
   const XMLElement *model = models->FirstChildElement ("model");
@@ -516,19 +843,8 @@ void operations_push_lights (const XMLElement *const lights, vector<float> &oper
   while ((light = light->NextSiblingElement ()));
 }
 
-void operations_load_xml (const string &filename, vector<float> &operations)
+void operations_push_world (const XMLDocument &doc, vector<float> &operations)
 {
-  XMLDocument doc;
-
-  if (doc.LoadFile (filename.c_str ()))
-    {
-      if (doc.ErrorID () == tinyxml2::XML_ERROR_FILE_NOT_FOUND)
-        cerr << "[parsing] Failed loading file: '" << filename << "'" << endl;
-      fprintf (stderr, "%s", doc.ErrorName ());
-      exit (EXIT_FAILURE);
-    }
-
-  cerr << "[parsing] Loaded file: '" << filename << "'" << endl;
   const XMLElement *const world = doc.FirstChildElement ("world");
   cerr << "[parsing] Loaded element: '" << world->Value () << "'" << endl;
 
@@ -580,29 +896,83 @@ void operations_load_xml (const string &filename, vector<float> &operations)
     operations_push_lights (lights, operations);
 
 
+  // optional texture cache settings (see @ref textureCache)
+  texture_cache_configure (*world);
+
   // find generator if it exists
   const XMLElement *const generator = world->FirstChildElement ("generator");
   if (generator != nullptr)
     {
-      const char *generator_executable[BUFSIZ];
-      if (generator->QueryStringAttribute ("dir", generator_executable))
-        {
-          cerr << "[parsing] failed parsing attribute dir of generator" << endl;
-          exit (EXIT_FAILURE);
-        }
-      if (access (*generator_executable, F_OK))
+      globalUsingGenerator = true;
+      generator->QueryBoolAttribute ("inProcess", &globalGeneratorInProcess);
+      if (globalGeneratorInProcess)
+        cerr << "[parsing] generating models in process" << endl;
+      else
         {
-          cerr << "[parsing] generator " << *generator_executable << " not found" << endl;
-          exit (EXIT_FAILURE);
+          const char *generator_executable[BUFSIZ];
+          if (generator->QueryStringAttribute ("dir", generator_executable))
+            {
+              cerr << "[parsing] failed parsing attribute dir of generator" << endl;
+              exit (EXIT_FAILURE);
+            }
+          if (access (*generator_executable, F_OK))
+            {
+              cerr << "[parsing] generator " << *generator_executable << " not found" << endl;
+              exit (EXIT_FAILURE);
+            }
+          cerr << "[parsing] using generator " << *generator_executable << endl;
+          strncpy (globalGeneratorExecutable, *generator_executable, BUFSIZ);
+
+          // optional model cache, cache="" disables it
+          const char *const cache = generator->Attribute ("cache");
+          globalModelCacheDir = cache ? cache : model_cache_default_dir ();
+          unsigned int cache_max_mb;
+          if (generator->QueryUnsignedAttribute ("cacheMaxMB", &cache_max_mb) == XML_SUCCESS)
+            globalModelCacheMaxBytes = (std::uintmax_t) cache_max_mb << 20;
         }
-      cerr << "[parsing] using generator " << *generator_executable << endl;
-      strncpy (globalGeneratorExecutable, *generator_executable, BUFSIZ);
-      globalUsingGenerator = true;
     }
 
   // groups
   const XMLElement *const group = world->FirstChildElement ("group");
   operations_push_groups (*group, operations);
+
+  operations_generate_models ();
+}
+
+void operations_load_xml (const string &filename, vector<float> &operations)
+{
+  XMLDocument doc;
+
+  if (doc.LoadFile (filename.c_str ()))
+    {
+      if (doc.ErrorID () == tinyxml2::XML_ERROR_FILE_NOT_FOUND)
+        cerr << "[parsing] Failed loading file: '" << filename << "'" << endl;
+      fprintf (stderr, "%s", doc.ErrorName ());
+      exit (EXIT_FAILURE);
+    }
+
+  cerr << "[parsing] Loaded file: '" << filename << "'" << endl;
+  operations_push_world (doc, operations);
+}
+
+/*!
+ * Parses the world of a scene pack (see @ref packFormat) from memory. Its model
+ * and texture files name entries of the pack, which the engine resolves, so
+ * they are not looked for in the file system.
+ */
+void operations_load_packed_xml (const char *const xml, const size_t size, vector<float> &operations)
+{
+  XMLDocument doc;
+
+  if (doc.Parse (xml, size))
+    {
+      cerr << "[parsing] Failed parsing packed world: " << doc.ErrorName () << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  cerr << "[parsing] Loaded packed world" << endl;
+  globalPackedWorld = true;
+  operations_push_world (doc, operations);
 }
 
 //! @} end of group xml
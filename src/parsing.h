@@ -2,8 +2,13 @@
 #define PROJ_PARSING_H
 
 #include <vector>
+#include <string>
+#include <cstdint>
+
+namespace tinyxml2 { class XMLElement; }
 
 void operations_load_xml (const std::string &filename, std::vector<float> &operations);
+void operations_load_packed_xml (const char *xml, size_t size, std::vector<float> &operations);
 
 enum {
   TRANSLATE = 1,
@@ -23,8 +28,20 @@ enum {
   SHININESS,
   POINT,
   DIRECTIONAL,
-  SPOTLIGHT
+  SPOTLIGHT,
+  GENERATOR,
+  CLOSED
 };
 
 typedef unsigned char operation_t;
+
+//! FNV-1a hashes of bytes and of a file's contents, the keys of the model and texture caches.
+const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325;
+uint64_t fnv1a (const void *data, size_t size, uint64_t hash = FNV_OFFSET_BASIS);
+uint64_t fnv1a_file (const std::string &path, uint64_t hash = FNV_OFFSET_BASIS);
+
+//! Texture cache directory, empty when caching is disabled, and its size limit, 0 means none (see @ref textureCache).
+extern std::string globalTextureCacheDir;
+extern std::uintmax_t globalTextureCacheMaxBytes;
+void texture_cache_configure (const tinyxml2::XMLElement &world);
 #endif //PROJ_PARSING_H
@@ -0,0 +1,39 @@
+#ifndef PROJ_PATCH_H
+#define PROJ_PATCH_H
+
+#include <cstdint>
+
+/*! @addtogroup patchFormat
+ * @{
+ * # Bezier patch files
+ *
+ * Text files list the control point indices of every patch, then the control
+ * points:
+ * @code{.unparsed}
+ * ⟨patch_file⟩ ::= ⟨nPatches⟩ ⟨newline⟩ ⟨patch⟩ⁿ ⟨nPoints⟩ ⟨newline⟩ ⟨point⟩ᵐ
+ *      ⟨patch⟩ ::= ⟨index⟩ ("," ⟨index⟩)¹⁵ ⟨newline⟩
+ *      ⟨point⟩ ::= ⟨float⟩ "," ⟨float⟩ "," ⟨float⟩ ⟨newline⟩
+ * @endcode
+ *
+ * Binary files (`generator --convert-patch`) hold the same arrays as they are
+ * laid out in memory, so loading them takes no parsing. Their magic is negative,
+ * so it can never be mistaken for the first digit of a text file.
+ * @code{.unparsed}
+ * ⟨binary_patch_file⟩ ::= ⟨patch_header⟩ ⟨uint32⟩¹⁶ⁿ ⟨vec3f⟩ᵐ
+ *      n ::= patch_header::nPatches
+ *      m ::= patch_header::nPoints
+ * @endcode
+ */
+
+const int32_t PATCH_MAGIC = -0xbe2;
+const uint32_t PATCH_VERSION = 1;
+
+struct patch_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t nPatches;
+  uint32_t nPoints;
+};
+
+//! @} end of group patchFormat
+#endif //PROJ_PATCH_H
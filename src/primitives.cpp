@@ -0,0 +1,3781 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <tuple>
+#include <iostream>
+#include <unistd.h>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <charconv>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "curves.h"
+#include "model.h"
+#include "patch.h"
+#include "primitives.h"
+
+using glm::mat4, glm::vec4, glm::vec3, glm::vec2, glm::mat4x3;
+using glm::normalize, glm::cross;
+
+using std::vector, std::tuple, std::array;
+
+using std::string, std::ifstream, std::ios, std::stringstream;
+using std::cerr, std::endl;
+
+template<class T>
+concept arithmetic =  std::is_integral<T>::value or std::is_floating_point<T>::value;
+
+const char *SPHERE = "sphere";
+const char *CUBE = "box";
+const char *CONE = "cone";
+const char *PLANE = "plane";
+const char *BEZIER = "bezier";
+const char *BEZIER_ADAPTIVE = "bezier-adaptive";
+const char *ICOSPHERE = "icosphere";
+const char *CUBESPHERE = "cubesphere";
+/*! @addtogroup generator
+* @{*/
+
+//! Worker threads used by parallel_for, 0 means one per hardware thread (see `--threads`).
+unsigned int globalThreads = 0;
+
+//! Stream this thread reports what it builds and writes to, errors always go to cerr (see generate_batch).
+thread_local std::ostream *globalLog = &cerr;
+
+//! Set on parallel_for's workers, so that nested calls run serially instead of oversubscribing.
+static thread_local bool globalIsWorker = false;
+
+/*!
+ * Calls body(i) for every i in [0, n), spreading the calls over globalThreads threads.
+ * Calls are handed out in order but may run concurrently, so body must only write
+ * to data owned by index i.
+ */
+void parallel_for (const size_t n, const std::function<void (size_t)> &body)
+{
+  unsigned int nThreads = globalThreads ? globalThreads : std::thread::hardware_concurrency ();
+  if (nThreads == 0 || globalIsWorker)
+    nThreads = 1;
+  if (nThreads > n)
+    nThreads = n;
+
+  if (nThreads <= 1)
+    {
+      for (size_t i = 0; i < n; ++i)
+        body (i);
+      return;
+    }
+
+  std::atomic<size_t> next = 0;
+  vector<std::thread> workers;
+  workers.reserve (nThreads);
+  for (unsigned int t = 0; t < nThreads; ++t)
+    workers.emplace_back ([&] {
+      globalIsWorker = true;
+      for (size_t i; (i = next++) < n;)
+        body (i);
+    });
+  for (auto &worker : workers)
+    worker.join ();
+}
+
+/*!
+ * Makes the parallel_for calls of the calling thread run serially, like those
+ * of parallel_for's own workers, for threads that already run side by side,
+ * one per hardware thread.
+ */
+void parallel_for_serial ()
+{
+  globalIsWorker = true;
+}
+
+/*! @addtogroup points
+ * @{*/
+struct weld_key {
+  uint32_t bits[8];
+  bool operator== (const weld_key &other) const
+  { return !memcmp (bits, other.bits, sizeof (bits)); }
+};
+
+struct weld_key_hash {
+  size_t operator() (const weld_key &key) const
+  {
+    size_t hash = 0xcbf29ce484222325;
+    for (const auto bits : key.bits)
+      hash = (hash ^ bits) * 0x100000001b3;
+    return hash;
+  }
+};
+
+/*!
+ * Merges vertices whose position, normal and texture coordinate are bitwise equal.
+ *
+ * @param[in,out] vertices unindexed triangle list on input, unique vertices on output.
+ * @param[in,out] normals same as vertices.
+ * @param[in,out] texture same as vertices.
+ * @param[out] indices three per triangle, pointing into the welded arrays.
+ */
+void model_weld (model_vector<vec3> &vertices,
+                 model_vector<vec3> &normals,
+                 model_vector<vec2> &texture,
+                 vector<uint32_t> &indices)
+{
+  std::unordered_map<weld_key, uint32_t, weld_key_hash> unique;
+  unique.reserve (vertices.size () / 4);
+  indices.resize (vertices.size ());
+
+  uint32_t nUnique = 0;
+  for (size_t i = 0; i < vertices.size (); ++i)
+    {
+      weld_key key{};
+      memcpy (key.bits, &vertices[i], sizeof (vec3));
+      memcpy (key.bits + 3, &normals[i], sizeof (vec3));
+      memcpy (key.bits + 6, &texture[i], sizeof (vec2));
+
+      const auto [it, inserted] = unique.try_emplace (key, nUnique);
+      if (inserted)
+        {
+          // nUnique ≤ i, so this never overwrites a vertex not yet visited
+          vertices[nUnique] = vertices[i];
+          normals[nUnique] = normals[i];
+          texture[nUnique] = texture[i];
+          ++nUnique;
+        }
+      indices[i] = it->second;
+    }
+
+  vertices.resize (nUnique);
+  normals.resize (nUnique);
+  texture.resize (nUnique);
+}
+
+//! Welded models are reordered by model_optimize before being written (see `--optimize`).
+bool globalOptimize = false;
+
+//! Entries of the LRU cache model_optimize_vertex_cache scores triangles against.
+const int VERTEX_CACHE_SCORE_SIZE = 32;
+
+//! Entries of the FIFO post-transform cache ACMR and ATVR are measured with.
+const size_t VERTEX_CACHE_FIFO_SIZE = 16;
+
+/*!
+ * ACMR a cluster of model_optimize_overdraw may reach, as a multiple of the
+ * ACMR of the stretch between cache flushes it is cut from, before it is cut
+ * (λ in Sander et al.). Lower values give fewer, longer clusters.
+ */
+const float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+//! Pixels per side of the views model_overdraw rasterizes.
+const int OVERDRAW_RESOLUTION = 256;
+
+//! Vertices transformed to draw indices through a FIFO cache of VERTEX_CACHE_FIFO_SIZE entries.
+static size_t model_cache_misses (const vector<uint32_t> &indices, const size_t nVertices)
+{
+  vector<size_t> inserted_at (nVertices, 0);
+  size_t misses = 0;
+  for (const auto v : indices)
+    if (!inserted_at[v] || misses - inserted_at[v] >= VERTEX_CACHE_FIFO_SIZE)
+      inserted_at[v] = ++misses;
+  return misses;
+}
+
+/*!
+ * Forsyth's vertex score: recently used vertices score higher, except the ones of
+ * the last triangle, and vertices with few triangles left are boosted so that
+ * they are finished off instead of being left behind.
+ */
+static float vertex_cache_score (const int cache_position, const uint32_t remaining)
+{
+  if (remaining == 0)
+    return -1;
+  float score = 0;
+  if (cache_position >= 0)
+    score = cache_position < 3
+            ? 0.75f
+            : powf (1 - (float) (cache_position - 3) / (VERTEX_CACHE_SCORE_SIZE - 3), 1.5f);
+  return score + 2 / sqrtf ((float) remaining);
+}
+
+/*!
+ * Reorders triangles for post-transform cache locality, following Tom Forsyth's
+ * "Linear-Speed Vertex Cache Optimisation": the next triangle is always the
+ * best scoring one among those using cached vertices.
+ */
+static void model_optimize_vertex_cache (vector<uint32_t> &indices, const size_t nVertices)
+{
+  const size_t nTriangles = indices.size () / 3;
+  constexpr auto NONE = (size_t) -1;
+
+  // triangles of every vertex, the ones not yet emitted first
+  vector<uint32_t> remaining (nVertices, 0);
+  for (const auto v : indices)
+    ++remaining[v];
+  vector<size_t> offsets (nVertices + 1, 0);
+  for (size_t v = 0; v < nVertices; ++v)
+    offsets[v + 1] = offsets[v] + remaining[v];
+  vector<uint32_t> adjacency (indices.size ());
+  {
+    vector<size_t> fill (offsets.begin (), offsets.end () - 1);
+    for (size_t i = 0; i < indices.size (); ++i)
+      adjacency[fill[indices[i]]++] = (uint32_t) (i / 3);
+  }
+
+  vector<int> cache_position (nVertices, -1);
+  vector<float> vertex_score (nVertices);
+  for (size_t v = 0; v < nVertices; ++v)
+    vertex_score[v] = vertex_cache_score (-1, remaining[v]);
+  vector<float> triangle_score (nTriangles);
+  vector<bool> emitted (nTriangles, false);
+  size_t best = NONE;
+  for (size_t t = 0; t < nTriangles; ++t)
+    {
+      triangle_score[t] = vertex_score[indices[3 * t]] + vertex_score[indices[3 * t + 1]]
+                          + vertex_score[indices[3 * t + 2]];
+      if (best == NONE || triangle_score[t] > triangle_score[best])
+        best = t;
+    }
+
+  vector<uint32_t> order;
+  order.reserve (indices.size ());
+  vector<uint32_t> cache, next_cache;
+  size_t cursor = 0;
+  while (order.size () < indices.size ())
+    {
+      // dead end, none of the cached vertices has triangles left
+      if (best == NONE)
+        {
+          while (emitted[cursor])
+            ++cursor;
+          best = cursor;
+        }
+
+      emitted[best] = true;
+      next_cache.clear ();
+      for (int k = 0; k < 3; ++k)
+        {
+          const uint32_t v = indices[3 * best + k];
+          order.push_back (v);
+          const auto begin = adjacency.begin () + (ptrdiff_t) offsets[v];
+          const auto end = begin + remaining[v];
+          std::iter_swap (std::find (begin, end, (uint32_t) best), end - 1);
+          --remaining[v];
+          if (std::find (next_cache.begin (), next_cache.end (), v) == next_cache.end ())
+            next_cache.push_back (v);
+        }
+      for (const auto v : cache)
+        if (std::find (next_cache.begin (), next_cache.begin () + 3, v) == next_cache.begin () + 3)
+          next_cache.push_back (v);
+
+      // vertices pushed out of the cache lose their cache score
+      for (size_t i = 0; i < next_cache.size (); ++i)
+        {
+          const uint32_t v = next_cache[i];
+          cache_position[v] = i < VERTEX_CACHE_SCORE_SIZE ? (int) i : -1;
+          vertex_score[v] = vertex_cache_score (cache_position[v], remaining[v]);
+        }
+
+      best = NONE;
+      for (const auto v : next_cache)
+        for (size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+          {
+            const uint32_t t = adjacency[a];
+            triangle_score[t] = vertex_score[indices[3 * t]] + vertex_score[indices[3 * t + 1]]
+                                + vertex_score[indices[3 * t + 2]];
+            if (best == NONE || triangle_score[t] > triangle_score[best])
+              best = t;
+          }
+
+      if (next_cache.size () > VERTEX_CACHE_SCORE_SIZE)
+        next_cache.resize (VERTEX_CACHE_SCORE_SIZE);
+      std::swap (cache, next_cache);
+    }
+  indices = std::move (order);
+}
+
+/*!
+ * Reorders the clusters of a cache optimized triangle list so that the ones
+ * facing away from the model's center, which are likely to occlude the rest,
+ * are drawn first ("Fast Triangle Reordering for Vertex Locality and Reduced
+ * Overdraw", Sander, Nehab and Barczak). The list is first cut where the cache
+ * is cold, at triangles missing on all of their vertices, and every stretch
+ * between those cuts is cut again, with the cache flushed, as soon as the ACMR
+ * since the last cut drops to OVERDRAW_ACMR_THRESHOLD times the stretch's, so
+ * the vertex cache locality is kept up to that factor.
+ *
+ * @return the number of clusters.
+ */
+static size_t model_optimize_overdraw (vector<uint32_t> &indices, const model_vector<vec3> &vertices)
+{
+  const size_t nTriangles = indices.size () / 3;
+
+  // a FIFO cache, as the time every vertex entered it, flushed by moving the time past every entry
+  vector<size_t> inserted_at (vertices.size (), 0);
+  size_t time = 0;
+  const auto triangle_misses = [&] (const size_t t) {
+    int misses = 0;
+    for (int k = 0; k < 3; ++k)
+      {
+        const uint32_t v = indices[3 * t + k];
+        if (!inserted_at[v] || time - inserted_at[v] >= VERTEX_CACHE_FIFO_SIZE)
+          {
+            inserted_at[v] = ++time;
+            ++misses;
+          }
+      }
+    return misses;
+  };
+  const auto flush = [&] { time += VERTEX_CACHE_FIFO_SIZE; };
+
+  vector<size_t> hard;
+  for (size_t t = 0; t < nTriangles; ++t)
+    if (triangle_misses (t) == 3 || t == 0)
+      hard.push_back (t);
+  hard.push_back (nTriangles);
+
+  vector<size_t> clusters;
+  for (size_t h = 0; h + 1 < hard.size (); ++h)
+    {
+      const size_t start = hard[h], end = hard[h + 1];
+      flush ();
+      size_t stretch_misses = 0;
+      for (size_t t = start; t < end; ++t)
+        stretch_misses += triangle_misses (t);
+      const float threshold = OVERDRAW_ACMR_THRESHOLD * (float) stretch_misses / (float) (end - start);
+
+      clusters.push_back (start);
+      flush ();
+      size_t misses = 0, triangles = 0;
+      for (size_t t = start; t < end; ++t)
+        {
+          misses += triangle_misses (t);
+          if ((float) misses / (float) ++triangles <= threshold && t + 1 < end)
+            {
+              clusters.push_back (t + 1);
+              flush ();
+              misses = triangles = 0;
+            }
+        }
+    }
+  clusters.push_back (nTriangles);
+
+  // area weighted centroid and normal of every cluster, and of the whole model
+  const size_t nClusters = clusters.size () - 1;
+  vector<vec3> centroids (nClusters, vec3 (0)), cluster_normals (nClusters, vec3 (0));
+  vec3 model_centroid (0);
+  float model_area = 0;
+  for (size_t c = 0; c < nClusters; ++c)
+    {
+      float area = 0;
+      for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+          const vec3 &a = vertices[indices[3 * t]];
+          const vec3 &b = vertices[indices[3 * t + 1]];
+          const vec3 &d = vertices[indices[3 * t + 2]];
+          const vec3 normal = cross (b - a, d - a);
+          const float triangle_area = glm::length (normal);
+          centroids[c] += (a + b + d) * (triangle_area / 3);
+          cluster_normals[c] += normal;
+          area += triangle_area;
+        }
+      model_centroid += centroids[c];
+      model_area += area;
+      if (area > 0)
+        centroids[c] /= area;
+    }
+  if (model_area > 0)
+    model_centroid /= model_area;
+
+  vector<float> sort_key (nClusters);
+  for (size_t c = 0; c < nClusters; ++c)
+    {
+      const float length = glm::length (cluster_normals[c]);
+      sort_key[c] = length > 0 ? glm::dot (centroids[c] - model_centroid, cluster_normals[c] / length) : 0;
+    }
+  vector<size_t> cluster_order (nClusters);
+  for (size_t c = 0; c < nClusters; ++c)
+    cluster_order[c] = c;
+  std::stable_sort (cluster_order.begin (), cluster_order.end (),
+                    [&] (const size_t a, const size_t b) { return sort_key[a] > sort_key[b]; });
+
+  vector<uint32_t> order;
+  order.reserve (indices.size ());
+  for (const auto c : cluster_order)
+    order.insert (order.end (), indices.begin () + (ptrdiff_t) (3 * clusters[c]),
+                  indices.begin () + (ptrdiff_t) (3 * clusters[c + 1]));
+  indices = std::move (order);
+  return nClusters;
+}
+
+/*!
+ * Overdraw of a triangle list, as the pixels shaded over the pixels covered
+ * when it is drawn, depth tested and without culling, from the six axis
+ * aligned directions at OVERDRAW_RESOLUTION² pixels.
+ */
+static float model_overdraw (const vector<uint32_t> &indices, const model_vector<vec3> &vertices)
+{
+  vec3 low (std::numeric_limits<float>::max ()), high (-std::numeric_limits<float>::max ());
+  for (const auto v : indices)
+    {
+      low = glm::min (low, vertices[v]);
+      high = glm::max (high, vertices[v]);
+    }
+  const vec3 extent = glm::max (high - low, vec3 (std::numeric_limits<float>::min ()));
+
+  size_t shaded = 0, covered = 0;
+  vector<float> depth_buffer ((size_t) OVERDRAW_RESOLUTION * OVERDRAW_RESOLUTION);
+  for (int axis = 0; axis < 3; ++axis)
+    for (const float direction : {1.f, -1.f})
+      {
+        const int u = (axis + 1) % 3, w = (axis + 2) % 3;
+        const auto project = [&] (const vec3 &p) {
+          return vec3 ((p[u] - low[u]) / extent[u] * OVERDRAW_RESOLUTION,
+                       (p[w] - low[w]) / extent[w] * OVERDRAW_RESOLUTION,
+                       direction * p[axis]);
+        };
+        const auto edge = [] (const vec3 &a, const vec3 &b, const float x, const float y) {
+          return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+        };
+        std::fill (depth_buffer.begin (), depth_buffer.end (), std::numeric_limits<float>::infinity ());
+        for (size_t i = 0; i + 2 < indices.size (); i += 3)
+          {
+            const vec3 a = project (vertices[indices[i]]);
+            const vec3 b = project (vertices[indices[i + 1]]);
+            const vec3 c = project (vertices[indices[i + 2]]);
+            const float area = edge (a, b, c.x, c.y);
+            if (area == 0)
+              continue;
+            const int x0 = std::max (0, (int) std::floor (std::min ({a.x, b.x, c.x})));
+            const int x1 = std::min (OVERDRAW_RESOLUTION - 1, (int) std::ceil (std::max ({a.x, b.x, c.x})));
+            const int y0 = std::max (0, (int) std::floor (std::min ({a.y, b.y, c.y})));
+            const int y1 = std::min (OVERDRAW_RESOLUTION - 1, (int) std::ceil (std::max ({a.y, b.y, c.y})));
+            for (int y = y0; y <= y1; ++y)
+              for (int x = x0; x <= x1; ++x)
+                {
+                  // pixel centers, either winding
+                  const float px = (float) x + .5f, py = (float) y + .5f;
+                  const float ba = edge (b, c, px, py) / area, bb = edge (c, a, px, py) / area;
+                  const float bc = 1 - ba - bb;
+                  if (ba < 0 || bb < 0 || bc < 0)
+                    continue;
+                  const float depth = ba * a.z + bb * b.z + bc * c.z;
+                  float &pixel = depth_buffer[(size_t) y * OVERDRAW_RESOLUTION + x];
+                  if (depth < pixel)
+                    {
+                      pixel = depth;
+                      ++shaded;
+                    }
+                }
+          }
+        for (const auto depth : depth_buffer)
+          covered += depth != std::numeric_limits<float>::infinity ();
+      }
+  return covered ? (float) shaded / (float) covered : 0;
+}
+
+/*!
+ * Renumbers the vertices in the order the triangles first use them, so that
+ * vertex fetches walk the arrays forward.
+ */
+static void model_optimize_vertex_fetch (model_vector<vec3> &vertices,
+                                         model_vector<vec3> &normals,
+                                         model_vector<vec2> &texture,
+                                         vector<uint32_t> &indices)
+{
+  constexpr auto UNUSED = (uint32_t) -1;
+  vector<uint32_t> remap (vertices.size (), UNUSED);
+  model_vector<vec3> fetched_vertices, fetched_normals;
+  model_vector<vec2> fetched_texture;
+  fetched_vertices.reserve (vertices.size ());
+  fetched_normals.reserve (vertices.size ());
+  fetched_texture.reserve (vertices.size ());
+  for (auto &v : indices)
+    {
+      if (remap[v] == UNUSED)
+        {
+          remap[v] = (uint32_t) fetched_vertices.size ();
+          fetched_vertices.push_back (vertices[v]);
+          fetched_normals.push_back (normals[v]);
+          fetched_texture.push_back (texture[v]);
+        }
+      v = remap[v];
+    }
+  vertices = std::move (fetched_vertices);
+  normals = std::move (fetched_normals);
+  texture = std::move (fetched_texture);
+}
+
+/*!
+ * Reorders a welded model's triangles for the post-transform vertex cache and
+ * then for overdraw, and its vertices for fetch locality. Reports the average
+ * cache miss ratio (misses per triangle, ACMR), the average transform to
+ * vertex ratio (misses per vertex, ATVR) before and after, and the overdraw
+ * (see model_overdraw) before and after the clusters are reordered for it.
+ */
+void model_optimize (model_vector<vec3> &vertices,
+                     model_vector<vec3> &normals,
+                     model_vector<vec2> &texture,
+                     vector<uint32_t> &indices)
+{
+  if (indices.empty ())
+    return;
+  const auto nTriangles = (double) (indices.size () / 3);
+  const auto nVertices = (double) vertices.size ();
+
+  const auto misses_before = (double) model_cache_misses (indices, vertices.size ());
+  model_optimize_vertex_cache (indices, vertices.size ());
+  const auto misses_cache = (double) model_cache_misses (indices, vertices.size ());
+  const float overdraw_cache = model_overdraw (indices, vertices);
+  const size_t nClusters = model_optimize_overdraw (indices, vertices);
+  const float overdraw_after = model_overdraw (indices, vertices);
+  model_optimize_vertex_fetch (vertices, normals, texture, indices);
+  const auto misses_after = (double) model_cache_misses (indices, vertices.size ());
+
+  *globalLog << "[generator] vertex cache (FIFO " << VERTEX_CACHE_FIFO_SIZE << "): ACMR "
+       << misses_before / nTriangles << " -> " << misses_after / nTriangles
+       << " (" << misses_cache / nTriangles << " before overdraw), ATVR "
+       << misses_before / nVertices << " -> " << misses_after / nVertices
+       << "; overdraw " << overdraw_cache << " -> " << overdraw_after << " over " << nClusters << " clusters" << endl;
+}
+
+//! Indices take 16 bits whenever the welded vertex count allows it.
+static uint32_t model_index_size (const size_t nVertices)
+{
+  return nVertices <= UINT16_MAX + 1 ? sizeof (uint16_t) : sizeof (uint32_t);
+}
+
+//! Writes the indices of an indexed model, narrowed to indexSize bytes.
+static void model_write_indices (FILE *const fp, const vector<uint32_t> &indices, const uint32_t indexSize)
+{
+  if (indexSize == sizeof (uint16_t))
+    {
+      const vector<uint16_t> short_indices (indices.begin (), indices.end ());
+      fwrite (short_indices.data (), sizeof (uint16_t), short_indices.size (), fp);
+    }
+  else
+    fwrite (indices.data (), sizeof (uint32_t), indices.size (), fp);
+}
+
+//! Writes the streams and the indices of an indexed model (see @ref modelFormat).
+static void model_write_arrays (FILE *const fp,
+                                const model_vector<vec3> &vertices,
+                                const model_vector<vec3> &normals,
+                                const model_vector<vec2> &texture,
+                                const vector<uint32_t> &indices,
+                                const uint32_t indexSize)
+{
+  fwrite (vertices.data (), sizeof (vec3), vertices.size (), fp);
+  fwrite (normals.data (), sizeof (vec3), normals.size (), fp);
+  fwrite (texture.data (), sizeof (vec2), texture.size (), fp);
+  model_write_indices (fp, indices, indexSize);
+}
+
+model_bounds model_compute_bounds (const float *const positions, const size_t nVertices, const size_t stride)
+{
+  model_bounds bounds{};
+  if (nVertices == 0)
+    return bounds;
+  vec3 lo (positions[0], positions[1], positions[2]);
+  vec3 hi = lo;
+  for (size_t v = 1; v < nVertices; ++v)
+    {
+      const vec3 position (positions[stride * v], positions[stride * v + 1], positions[stride * v + 2]);
+      lo = glm::min (lo, position);
+      hi = glm::max (hi, position);
+    }
+  const vec3 center = (lo + hi) * 0.5f;
+  float radius = 0;
+  for (size_t v = 0; v < nVertices; ++v)
+    {
+      const vec3 position (positions[stride * v], positions[stride * v + 1], positions[stride * v + 2]);
+      radius = std::max (radius, glm::distance (center, position));
+    }
+  for (int axis = 0; axis < 3; ++axis)
+    {
+      bounds.min[axis] = lo[axis];
+      bounds.max[axis] = hi[axis];
+      bounds.center[axis] = center[axis];
+    }
+  bounds.radius = radius;
+  return bounds;
+}
+
+//! Every vertex's position, normal and texture coordinate together, 8 floats a vertex.
+static vector<float> model_interleave (const model_vector<vec3> &vertices,
+                                       const model_vector<vec3> &normals,
+                                       const model_vector<vec2> &texture)
+{
+  vector<float> interleaved_vertices;
+  interleaved_vertices.reserve (8 * vertices.size ());
+  for (size_t v = 0; v < vertices.size (); ++v)
+    interleaved_vertices.insert (interleaved_vertices.end (), {
+        vertices[v].x, vertices[v].y, vertices[v].z,
+        normals[v].x, normals[v].y, normals[v].z,
+        texture[v].x, texture[v].y
+    });
+  return interleaved_vertices;
+}
+
+//! Writes a header, with MODEL_BOUNDED in its version, followed by its model_bounds.
+template<typename Header>
+static void model_write_header (FILE *const fp, Header header, const model_bounds &bounds)
+{
+  header.version |= MODEL_BOUNDED;
+  fwrite (&header, sizeof (header), 1, fp);
+  fwrite (&bounds, sizeof (bounds), 1, fp);
+}
+
+/*!
+ * Welds the unindexed triangle list and writes it as an indexed .3d file,
+ * with its vertices interleaved if asked to (see @ref modelFormat).
+ */
+void
+model_write (const char *const filename,
+             model_vector<vec3> &vertices,
+             model_vector<vec3> &normals,
+             model_vector<vec2> &texture,
+             const bool interleaved)
+{
+  FILE *fp = fopen (filename, "w");
+
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", filename);
+      exit (1);
+    }
+
+  assert(vertices.size () < INT_MAX);
+  const size_t nUnweldedVertices = vertices.size ();
+  vector<uint32_t> indices;
+  model_weld (vertices, normals, texture, indices);
+  if (globalOptimize)
+    model_optimize (vertices, normals, texture, indices);
+
+  model_header header{};
+  header.magic = MODEL_MAGIC;
+  header.version = interleaved ? MODEL_VERSION_INTERLEAVED : MODEL_VERSION;
+  header.nVertices = vertices.size ();
+  header.nIndices = indices.size ();
+  header.indexSize = model_index_size (header.nVertices);
+
+  model_write_header (fp, header, model_compute_bounds ((const float *) vertices.data (), vertices.size ()));
+  if (interleaved)
+    {
+      const vector<float> interleaved_vertices = model_interleave (vertices, normals, texture);
+      fwrite (interleaved_vertices.data (), sizeof (float), interleaved_vertices.size (), fp);
+      model_write_indices (fp, indices, header.indexSize);
+    }
+  else
+    model_write_arrays (fp, vertices, normals, texture, indices, header.indexSize);
+
+  fclose (fp);
+
+  *globalLog << "[generator] Wrote "
+       << header.nVertices << " vertices (welded from " << nUnweldedVertices << "), "
+       << header.nIndices << " indices of " << header.indexSize << " bytes to "
+       << filename << endl;
+}
+
+//! Packs a unit normal into the 10-10-10-2 signed normalized layout of GL_INT_2_10_10_10_REV.
+static uint32_t model_pack_normal (const vec3 normal)
+{
+  uint32_t packed = 0;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+      const auto component = (int32_t) std::lround (std::clamp (normal[axis], -1.0f, 1.0f) * 511.0f);
+      packed |= ((uint32_t) component & 0x3ff) << (10 * axis);
+    }
+  return packed;
+}
+
+/*!
+ * Welds the unindexed triangle list and writes it as a quantized .3d file
+ * (see @ref modelFormat). Normals take 4 bytes and texture coordinates 4 bytes,
+ * and positions 8 bytes instead of 12 when quantize_positions is set.
+ */
+void
+model_quantized_write (const char *const filename,
+                       model_vector<vec3> &vertices,
+                       model_vector<vec3> &normals,
+                       model_vector<vec2> &texture,
+                       const bool quantize_positions)
+{
+  FILE *fp = fopen (filename, "w");
+
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", filename);
+      exit (1);
+    }
+
+  assert(vertices.size () < INT_MAX);
+  const size_t nUnweldedVertices = vertices.size ();
+  vector<uint32_t> indices;
+  model_weld (vertices, normals, texture, indices);
+  if (globalOptimize)
+    model_optimize (vertices, normals, texture, indices);
+
+  model_quantized_header header{};
+  header.magic = MODEL_MAGIC;
+  header.version = MODEL_VERSION_QUANTIZED;
+  header.nVertices = vertices.size ();
+  header.nIndices = indices.size ();
+  header.indexSize = model_index_size (header.nVertices);
+  header.attributes = quantize_positions ? MODEL_QUANTIZED_POSITIONS : 0;
+
+  // positions are dequantized by a uniform scale about the center of their bounding box
+  vec3 lo (0), hi (0);
+  vec2 texture_lo (0), texture_hi (0);
+  if (!vertices.empty ())
+    {
+      lo = hi = vertices[0];
+      texture_lo = texture_hi = texture[0];
+    }
+  for (size_t v = 0; v < vertices.size (); ++v)
+    {
+      lo = glm::min (lo, vertices[v]);
+      hi = glm::max (hi, vertices[v]);
+      texture_lo = glm::min (texture_lo, texture[v]);
+      texture_hi = glm::max (texture_hi, texture[v]);
+    }
+  const vec3 center = (lo + hi) / 2.0f;
+  const vec3 extent = (hi - lo) / 2.0f;
+  const float half_extent = std::max ({extent.x, extent.y, extent.z});
+  header.positionScale = half_extent > 0 ? half_extent / MODEL_QUANTIZED_MAX : 1;
+  for (int axis = 0; axis < 3; ++axis)
+    header.positionOffset[axis] = center[axis];
+  for (int axis = 0; axis < 2; ++axis)
+    {
+      header.textureOffset[axis] = texture_lo[axis];
+      const float range = texture_hi[axis] - texture_lo[axis];
+      header.textureScale[axis] = range > 0 ? range / MODEL_QUANTIZED_MAX : 1;
+    }
+
+  // rounding moves a quantized position by up to half a step along every axis
+  model_bounds bounds = model_compute_bounds ((const float *) vertices.data (), vertices.size ());
+  if (quantize_positions)
+    {
+      const float step = header.positionScale / 2;
+      for (int axis = 0; axis < 3; ++axis)
+        {
+          bounds.min[axis] -= step;
+          bounds.max[axis] += step;
+        }
+      bounds.radius += std::sqrt (3.0f) * step;
+    }
+  model_write_header (fp, header, bounds);
+
+  if (quantize_positions)
+    {
+      // padded to 4 components so every position stays 4-byte aligned
+      vector<int16_t> positions (4 * vertices.size (), 0);
+      for (size_t v = 0; v < vertices.size (); ++v)
+        for (int axis = 0; axis < 3; ++axis)
+          positions[4 * v + axis] = (int16_t) std::lround ((vertices[v][axis] - center[axis]) / header.positionScale);
+      fwrite (positions.data (), sizeof (int16_t), positions.size (), fp);
+    }
+  else
+    fwrite (vertices.data (), sizeof (vec3), vertices.size (), fp);
+
+  vector<uint32_t> packed_normals (normals.size ());
+  for (size_t v = 0; v < normals.size (); ++v)
+    packed_normals[v] = model_pack_normal (normals[v]);
+  fwrite (packed_normals.data (), sizeof (uint32_t), packed_normals.size (), fp);
+
+  vector<int16_t> texture_coordinates (2 * texture.size ());
+  for (size_t v = 0; v < texture.size (); ++v)
+    for (int axis = 0; axis < 2; ++axis)
+      texture_coordinates[2 * v + axis] = (int16_t) std::lround (
+          (texture[v][axis] - header.textureOffset[axis]) / header.textureScale[axis]);
+  fwrite (texture_coordinates.data (), sizeof (int16_t), texture_coordinates.size (), fp);
+
+  model_write_indices (fp, indices, header.indexSize);
+
+  const long size = ftell (fp);
+  fclose (fp);
+
+  *globalLog << "[generator] Wrote "
+       << header.nVertices << " quantized vertices (welded from " << nUnweldedVertices << "), "
+       << header.nIndices << " indices of " << header.indexSize << " bytes, "
+       << size << " bytes to " << filename << endl;
+}
+
+/*!
+ * Splits a welded model into clusters of at most MODEL_CLUSTER_VERTICES
+ * vertices and MODEL_CLUSTER_TRIANGLES triangles, reordering its indices so
+ * that every cluster is a contiguous range. Clusters grow from a seed triangle
+ * through the triangles sharing its vertices, taking first the ones that add
+ * the fewest new vertices, so they stay compact.
+ */
+static vector<model_cluster> model_build_clusters (const model_vector<vec3> &vertices, vector<uint32_t> &indices)
+{
+  const size_t nTriangles = indices.size () / 3;
+
+  // triangles of every vertex
+  vector<size_t> offsets (vertices.size () + 1, 0);
+  for (const auto v : indices)
+    ++offsets[v + 1];
+  for (size_t v = 0; v < vertices.size (); ++v)
+    offsets[v + 1] += offsets[v];
+  vector<uint32_t> adjacency (indices.size ());
+  {
+    vector<size_t> fill (offsets.begin (), offsets.end () - 1);
+    for (size_t i = 0; i < indices.size (); ++i)
+      adjacency[fill[indices[i]]++] = (uint32_t) (i / 3);
+  }
+
+  vector<model_cluster> clusters;
+  vector<uint32_t> clustered;
+  clustered.reserve (indices.size ());
+  vector<bool> assigned (nTriangles, false);
+  // cluster (plus one) a vertex was last added to
+  vector<uint32_t> vertex_cluster (vertices.size (), 0);
+  vector<uint32_t> candidates, cluster_vertices;
+  size_t seed = 0;
+  while (clustered.size () < indices.size ())
+    {
+      while (assigned[seed])
+        ++seed;
+      const auto id = (uint32_t) clusters.size () + 1;
+      model_cluster cluster{};
+      cluster.firstIndex = clustered.size ();
+      cluster_vertices.clear ();
+      candidates.assign (1, (uint32_t) seed);
+
+      size_t nClusterTriangles = 0;
+      while (nClusterTriangles < MODEL_CLUSTER_TRIANGLES)
+        {
+          // the candidate adding the fewest vertices, the earliest one on ties
+          size_t best = candidates.size ();
+          int best_new = 4;
+          for (size_t c = 0; c < candidates.size () && best_new > 0; ++c)
+            {
+              if (assigned[candidates[c]])
+                continue;
+              int new_vertices = 0;
+              for (int k = 0; k < 3; ++k)
+                new_vertices += vertex_cluster[indices[3 * candidates[c] + k]] != id;
+              if (new_vertices < best_new)
+                {
+                  best = c;
+                  best_new = new_vertices;
+                }
+            }
+          if (best == candidates.size () || cluster_vertices.size () + best_new > MODEL_CLUSTER_VERTICES)
+            break;
+
+          const uint32_t t = candidates[best];
+          assigned[t] = true;
+          ++nClusterTriangles;
+          for (int k = 0; k < 3; ++k)
+            {
+              const uint32_t v = indices[3 * t + k];
+              clustered.push_back (v);
+              if (vertex_cluster[v] == id)
+                continue;
+              vertex_cluster[v] = id;
+              cluster_vertices.push_back (v);
+              for (size_t a = offsets[v]; a < offsets[v + 1]; ++a)
+                if (!assigned[adjacency[a]])
+                  candidates.push_back (adjacency[a]);
+            }
+          // drop the candidates taken meanwhile, so the scan stays short
+          candidates.erase (std::remove_if (candidates.begin (), candidates.end (),
+                                            [&] (const uint32_t c) { return assigned[c]; }),
+                            candidates.end ());
+        }
+      cluster.nIndices = 3 * nClusterTriangles;
+
+      // bounding sphere around the center of the bounding box
+      vec3 lo = vertices[cluster_vertices[0]], hi = lo;
+      for (const auto v : cluster_vertices)
+        {
+          lo = glm::min (lo, vertices[v]);
+          hi = glm::max (hi, vertices[v]);
+        }
+      const vec3 center = (lo + hi) / 2.0f;
+      float radius = 0;
+      for (const auto v : cluster_vertices)
+        radius = std::max (radius, glm::length (vertices[v] - center));
+
+      // normal cone of the faces, as wound, the cluster is back facing from anywhere
+      // whose direction to the center is within asin(coneCutoff) of the axis
+      vector<vec3> face_normals;
+      vec3 axis (0);
+      for (size_t i = cluster.firstIndex; i < clustered.size (); i += 3)
+        {
+          const vec3 normal = cross (vertices[clustered[i + 1]] - vertices[clustered[i]],
+                                     vertices[clustered[i + 2]] - vertices[clustered[i]]);
+          const float length = glm::length (normal);
+          if (length > 0)
+            {
+              face_normals.push_back (normal / length);
+              axis += normal / length;
+            }
+        }
+      const float axis_length = glm::length (axis);
+      float min_dot = 1;
+      if (axis_length > 0)
+        {
+          axis /= axis_length;
+          for (const auto &normal : face_normals)
+            min_dot = std::min (min_dot, glm::dot (axis, normal));
+        }
+      // a cone as wide as a hemisphere, or wider, is never back facing
+      const float cutoff = axis_length > 0 && min_dot > 0 ? sqrtf (1 - min_dot * min_dot) : 2;
+
+      for (int axis_index = 0; axis_index < 3; ++axis_index)
+        {
+          cluster.center[axis_index] = center[axis_index];
+          cluster.coneAxis[axis_index] = axis[axis_index];
+        }
+      cluster.radius = radius;
+      cluster.coneCutoff = cutoff;
+      clusters.push_back (cluster);
+    }
+
+  indices = std::move (clustered);
+  return clusters;
+}
+
+/*!
+ * Welds the unindexed triangle list, splits it into clusters (see
+ * model_build_clusters) and writes it as a clustered .3d file (see @ref
+ * modelFormat), so the engine can cull every cluster on its own.
+ */
+void
+model_cluster_write (const char *const filename,
+                     model_vector<vec3> &vertices,
+                     model_vector<vec3> &normals,
+                     model_vector<vec2> &texture)
+{
+  FILE *fp = fopen (filename, "w");
+
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", filename);
+      exit (1);
+    }
+
+  assert(vertices.size () < INT_MAX);
+  const size_t nUnweldedVertices = vertices.size ();
+  vector<uint32_t> indices;
+  model_weld (vertices, normals, texture, indices);
+  if (globalOptimize)
+    model_optimize (vertices, normals, texture, indices);
+  const vector<model_cluster> clusters = model_build_clusters (vertices, indices);
+
+  model_cluster_header header{};
+  header.magic = MODEL_MAGIC;
+  header.version = MODEL_VERSION_CLUSTERS;
+  header.nVertices = vertices.size ();
+  header.nIndices = indices.size ();
+  header.indexSize = model_index_size (header.nVertices);
+  header.nClusters = clusters.size ();
+
+  model_write_header (fp, header, model_compute_bounds ((const float *) vertices.data (), vertices.size ()));
+  model_write_arrays (fp, vertices, normals, texture, indices, header.indexSize);
+  fwrite (clusters.data (), sizeof (model_cluster), clusters.size (), fp);
+
+  fclose (fp);
+
+  *globalLog << "[generator] Wrote "
+       << header.nVertices << " vertices (welded from " << nUnweldedVertices << "), "
+       << header.nIndices << " indices of " << header.indexSize << " bytes in "
+       << header.nClusters << " clusters (" << (double) header.nIndices / 3 / header.nClusters
+       << " triangles each on average) to " << filename << endl;
+}
+
+/*!
+ * Welds the unindexed triangle list and writes it as a sectioned .3d file (see
+ * @ref modelFormat), with its vertices interleaved and its triangles split in
+ * clusters (see model_build_clusters) if asked to.
+ */
+void
+model_sections_write (const char *const filename,
+                      model_vector<vec3> &vertices,
+                      model_vector<vec3> &normals,
+                      model_vector<vec2> &texture,
+                      const bool interleaved,
+                      const bool clustered)
+{
+  FILE *fp = fopen (filename, "w");
+
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", filename);
+      exit (1);
+    }
+
+  assert(vertices.size () < INT_MAX);
+  const size_t nUnweldedVertices = vertices.size ();
+  vector<uint32_t> indices;
+  model_weld (vertices, normals, texture, indices);
+  if (globalOptimize)
+    model_optimize (vertices, normals, texture, indices);
+  vector<model_cluster> clusters;
+  if (clustered)
+    clusters = model_build_clusters (vertices, indices);
+
+  model_sections_header header{};
+  header.magic = MODEL_MAGIC;
+  header.version = MODEL_VERSION_SECTIONS;
+  header.headerSize = sizeof (header);
+  header.nVertices = vertices.size ();
+  header.nIndices = indices.size ();
+  header.indexSize = model_index_size (header.nVertices);
+  header.nClusters = clusters.size ();
+
+  // the sections, in file order, each pointing at what it writes
+  vector<model_section> sections;
+  vector<const void *> data;
+  const auto add_section = [&] (const uint32_t type, const void *const section_data, const size_t size) {
+    sections.push_back ({type, 0, 0, size});
+    data.push_back (section_data);
+  };
+  vector<float> interleaved_vertices;
+  if (interleaved)
+    {
+      interleaved_vertices = model_interleave (vertices, normals, texture);
+      add_section (MODEL_SECTION_INTERLEAVED, interleaved_vertices.data (), sizeof (float) * interleaved_vertices.size ());
+    }
+  else
+    {
+      add_section (MODEL_SECTION_POSITIONS, vertices.data (), sizeof (vec3) * vertices.size ());
+      add_section (MODEL_SECTION_NORMALS, normals.data (), sizeof (vec3) * normals.size ());
+      add_section (MODEL_SECTION_TEXTURE, texture.data (), sizeof (vec2) * texture.size ());
+    }
+  vector<uint16_t> short_indices;
+  if (header.indexSize == sizeof (uint16_t))
+    short_indices.assign (indices.begin (), indices.end ());
+  add_section (MODEL_SECTION_INDICES, short_indices.empty () ? (const void *) indices.data () : short_indices.data (),
+               (size_t) header.indexSize * indices.size ());
+  if (clustered)
+    add_section (MODEL_SECTION_CLUSTERS, clusters.data (), sizeof (model_cluster) * clusters.size ());
+
+  header.nSections = sections.size ();
+  const auto align = [] (const uint64_t offset) {
+    return (offset + MODEL_SECTION_ALIGNMENT - 1) / MODEL_SECTION_ALIGNMENT * MODEL_SECTION_ALIGNMENT;
+  };
+  uint64_t offset = sizeof (header) + sizeof (model_bounds) + sizeof (model_section) * sections.size ();
+  for (auto &section : sections)
+    {
+      section.offset = align (offset);
+      offset = section.offset + section.size;
+    }
+  header.fileSize = offset;
+
+  model_write_header (fp, header, model_compute_bounds ((const float *) vertices.data (), vertices.size ()));
+  fwrite (sections.data (), sizeof (model_section), sections.size (), fp);
+  static const char zeros[MODEL_SECTION_ALIGNMENT] = {};
+  for (size_t section = 0; section < sections.size (); ++section)
+    {
+      fwrite (zeros, 1, sections[section].offset - ftell (fp), fp);
+      fwrite (data[section], 1, sections[section].size, fp);
+    }
+
+  fclose (fp);
+
+  *globalLog << "[generator] Wrote "
+       << header.nVertices << " vertices (welded from " << nUnweldedVertices << "), "
+       << header.nIndices << " indices of " << header.indexSize << " bytes in "
+       << header.nSections << " sections, " << header.fileSize << " bytes to " << filename << endl;
+}
+
+/*!
+ * Hands the triangles built so far to the sink and clears them, once there are
+ * at least sink->chunkVertices of them, or any at all on the last call.
+ * Does nothing without a sink, so builders call it unconditionally.
+ */
+static void model_sink_flush (model_sink *const sink,
+                              model_vector<vec3> &vertices,
+                              model_vector<vec3> &normals,
+                              model_vector<vec2> &texture,
+                              const bool last = false)
+{
+  if (!sink || vertices.empty () || (!last && vertices.size () < sink->chunkVertices))
+    return;
+  sink->write (vertices, normals, texture);
+  vertices.clear ();
+  normals.clear ();
+  texture.clear ();
+}
+
+/*!
+ * Builds the model described by a ⟨model⟩ (without its ⟨out_file⟩, see
+ * generate_model) and writes it as a streamed .3d file (see @ref modelFormat),
+ * one chunk of MODEL_STREAM_CHUNK vertices at a time. Each stream's region of
+ * the file is known from the vertex count, so every chunk is written straight
+ * to its place and memory use does not grow with the model. The bounding
+ * sphere is centered once the whole box is known, so its radius is found by
+ * reading the positions back, a chunk at a time too.
+ */
+void model_stream_write (const char *const filename, const int argc, const char *const argv[])
+{
+  FILE *fp = fopen (filename, "w+");
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", filename);
+      exit (1);
+    }
+
+  model_stream_header header{};
+  header.magic = MODEL_MAGIC;
+  header.version = MODEL_VERSION_STREAM | MODEL_BOUNDED;
+  uint64_t nWritten = 0;
+  vec3 lo (INFINITY), hi (-INFINITY);
+
+  const auto put = [&] (const uint64_t offset, const void *const data, const size_t size, const size_t count) {
+    if (fseeko (fp, (off_t) offset, SEEK_SET) || fwrite (data, size, count, fp) != count)
+      {
+        perror ("[generator] failed writing streamed model");
+        exit (EXIT_FAILURE);
+      }
+  };
+
+  model_sink sink;
+  sink.chunkVertices = MODEL_STREAM_CHUNK;
+  sink.begin = [&] (const uint64_t nVertices) {
+    header.nVertices = nVertices;
+    put (0, &header, sizeof (header), 1);
+  };
+  const uint64_t positions = sizeof (header) + sizeof (model_bounds);
+  sink.write = [&] (const model_vector<vec3> &vertices, const model_vector<vec3> &normals, const model_vector<vec2> &texture) {
+    const uint64_t normals_offset = positions + header.nVertices * sizeof (vec3);
+    const uint64_t texture_offset = normals_offset + header.nVertices * sizeof (vec3);
+    put (positions + nWritten * sizeof (vec3), vertices.data (), sizeof (vec3), vertices.size ());
+    put (normals_offset + nWritten * sizeof (vec3), normals.data (), sizeof (vec3), normals.size ());
+    put (texture_offset + nWritten * sizeof (vec2), texture.data (), sizeof (vec2), texture.size ());
+    nWritten += vertices.size ();
+    for (const auto &vertex : vertices)
+      {
+        lo = glm::min (lo, vertex);
+        hi = glm::max (hi, vertex);
+      }
+  };
+
+  model_vector<vec3> vertices;
+  model_vector<vec3> normals;
+  model_vector<vec2> texture;
+  generate_model (argc, argv, vertices, normals, texture, &sink);
+
+  model_bounds bounds{};
+  if (nWritten > 0)
+    {
+      const vec3 center = (lo + hi) * 0.5f;
+      vertices.resize (MODEL_STREAM_CHUNK);
+      fseeko (fp, (off_t) positions, SEEK_SET);
+      for (uint64_t nRead = 0; nRead < nWritten;)
+        {
+          const size_t n = fread (vertices.data (), sizeof (vec3),
+                                  (size_t) std::min<uint64_t> (vertices.size (), nWritten - nRead), fp);
+          if (n == 0)
+            {
+              perror ("[generator] failed reading streamed model back");
+              exit (EXIT_FAILURE);
+            }
+          for (size_t v = 0; v < n; ++v)
+            bounds.radius = std::max (bounds.radius, glm::distance (center, vertices[v]));
+          nRead += n;
+        }
+      for (int axis = 0; axis < 3; ++axis)
+        {
+          bounds.min[axis] = lo[axis];
+          bounds.max[axis] = hi[axis];
+          bounds.center[axis] = center[axis];
+        }
+    }
+  put (sizeof (header), &bounds, sizeof (bounds), 1);
+  fclose (fp);
+
+  if (nWritten != header.nVertices)
+    {
+      cerr << "[generator] " << nWritten << " = nWritten != nVertices = " << header.nVertices << endl;
+      exit (EXIT_FAILURE);
+    }
+  *globalLog << "[generator] Streamed " << header.nVertices << " vertices in chunks of "
+       << sink.chunkVertices << " to " << filename << endl;
+}
+
+/*!
+ * The ⟨model⟩ of a level of detail: level 0 is the model itself and every
+ * level halves the resolution of the previous one, i.e. its divisions,
+ * slices and stacks or tesselation, or doubles its maximum error.
+ */
+static vector<string> model_lod_argv (const int argc, const char *const argv[], const int level)
+{
+  vector<string> words (argv, argv + argc);
+  if (argc < 4 || level == 0)
+    return words;
+
+  const auto halve = [&] (const int i, const int minimum) {
+    if (i < argc)
+      words[i] = std::to_string (std::max (std::stoi (words[i]) >> level, minimum));
+  };
+  const string polygon = argv[1];
+  if (polygon == PLANE || polygon == CUBE || polygon == BEZIER)
+    halve (3, 1);
+  else if (polygon == SPHERE)
+    {
+      halve (3, 3);
+      halve (4, 2);
+    }
+  else if (polygon == CONE)
+    {
+      halve (4, 3);
+      halve (5, 1);
+    }
+  else if (polygon == BEZIER_ADAPTIVE)
+    words[3] = std::to_string (strtof (argv[3], nullptr) * (float) (1 << level));
+  else if (polygon == ICOSPHERE)
+    words[3] = std::to_string (std::max (std::stoi (words[3]) - level, 0));
+  else if (polygon == CUBESPHERE)
+    halve (3, 1);
+  return words;
+}
+
+/*!
+ * Builds nLevels levels of detail of a ⟨model⟩ (without its ⟨out_file⟩, see
+ * generate_model and model_lod_argv) and writes them, each welded and
+ * indexed, to a single .3d file (see @ref modelFormat). Its bounds enclose
+ * every level, coarser levels need not stay inside the finest one.
+ */
+void model_lod_write (const char *const filename, const int argc, const char *const argv[], const int nLevels)
+{
+  FILE *fp = fopen (filename, "w");
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", filename);
+      exit (1);
+    }
+
+  model_lod_header header{};
+  header.magic = MODEL_MAGIC;
+  header.version = MODEL_VERSION_LOD;
+  header.nLevels = nLevels;
+  // the bounds are written once every level is known
+  model_write_header (fp, header, model_bounds{});
+  vector<model_bounds> level_bounds;
+
+  for (int level = 0; level < nLevels; ++level)
+    {
+      const vector<string> words = model_lod_argv (argc, argv, level);
+      vector<const char *> level_argv;
+      for (const auto &word : words)
+        level_argv.push_back (word.c_str ());
+
+      model_vector<vec3> vertices;
+      model_vector<vec3> normals;
+      model_vector<vec2> texture;
+      generate_model ((int) level_argv.size (), level_argv.data (), vertices, normals, texture);
+      assert(vertices.size () < INT_MAX);
+      vector<uint32_t> indices;
+      model_weld (vertices, normals, texture, indices);
+      if (globalOptimize)
+        model_optimize (vertices, normals, texture, indices);
+
+      level_bounds.push_back (model_compute_bounds ((const float *) vertices.data (), vertices.size ()));
+
+      model_level_header level_header{};
+      level_header.nVertices = vertices.size ();
+      level_header.nIndices = indices.size ();
+      level_header.indexSize = model_index_size (level_header.nVertices);
+      fwrite (&level_header, sizeof (level_header), 1, fp);
+      model_write_arrays (fp, vertices, normals, texture, indices, level_header.indexSize);
+
+      *globalLog << "[generator] level " << level << ": "
+           << level_header.nVertices << " vertices, " << level_header.nIndices << " indices" << endl;
+    }
+
+  model_bounds bounds = level_bounds[0];
+  for (const auto &level : level_bounds)
+    for (int axis = 0; axis < 3; ++axis)
+      {
+        bounds.min[axis] = std::min (bounds.min[axis], level.min[axis]);
+        bounds.max[axis] = std::max (bounds.max[axis], level.max[axis]);
+      }
+  const vec3 center = (glm::make_vec3 (bounds.min) + glm::make_vec3 (bounds.max)) * 0.5f;
+  bounds.radius = 0;
+  for (const auto &level : level_bounds)
+    bounds.radius = std::max (bounds.radius, glm::distance (center, glm::make_vec3 (level.center)) + level.radius);
+  for (int axis = 0; axis < 3; ++axis)
+    bounds.center[axis] = center[axis];
+  fseek (fp, 0, SEEK_SET);
+  model_write_header (fp, header, bounds);
+
+  fclose (fp);
+  *globalLog << "[generator] Wrote " << nLevels << " levels of detail to " << filename << endl;
+}
+
+//!@} end of group points
+
+/*! @addtogroup simplify
+ * @{
+ * `generator simplify` decimates an existing .3d file with quadric error
+ * metrics (Garland and Heckbert). Every vertex position accumulates the planes
+ * of its triangles, weighted by their area, and edges are collapsed cheapest
+ * first, the error of a collapse being the root mean square distance from the
+ * planes of the position that goes away to the position it moves onto.
+ *
+ * Collapses are half-edge collapses, onto an existing position, so every
+ * vertex left keeps its exact normal and texture coordinate. A position may
+ * hold several vertices (a UV seam, or a crease with split normals), and it
+ * only collapses if each of its vertices has exactly one partner at the other
+ * end of the edge, so seams stay seams. A collapse is also refused when it
+ * would slide a border vertex off its border, change the topology (the link
+ * condition), or turn a triangle around. Flat shaded models, whose triangles
+ * each have their own normals, are all seams and hardly simplify.
+ *
+ * The error reached is the largest error of the collapses made, which falls
+ * short of the distance to the original surface: `sphere 1 200 200` kept at
+ * 10% and 2% reports 0.0010 and 0.0053, and strays 0.0044 and 0.0103 from the
+ * sphere.
+ */
+
+/*!
+ * Reads a .3d file of any version (see @ref modelFormat) as an unindexed
+ * triangle list: indexed files are expanded, quantized streams dequantized,
+ * and files with levels of detail give their finest level.
+ */
+void model_read (const char *const filename,
+                 model_vector<vec3> &vertices,
+                 model_vector<vec3> &normals,
+                 model_vector<vec2> &texture)
+{
+  FILE *fp = fopen (filename, "r");
+  if (!fp)
+    {
+      cerr << "[generator] failed to open model " << filename << endl;
+      exit (EXIT_FAILURE);
+    }
+  const auto read = [&] (void *const data, const size_t size, const size_t count) {
+    if (fread (data, size, count, fp) != count)
+      {
+        cerr << "[generator] model " << filename << " is truncated" << endl;
+        exit (EXIT_FAILURE);
+      }
+  };
+  const auto read_planar = [&] (const size_t nVertices) {
+    vertices.resize (nVertices);
+    normals.resize (nVertices);
+    texture.resize (nVertices);
+    read (vertices.data (), sizeof (vec3), nVertices);
+    read (normals.data (), sizeof (vec3), nVertices);
+    read (texture.data (), sizeof (vec2), nVertices);
+  };
+  const auto read_interleaved = [&] (const size_t nVertices) {
+    vector<float> interleaved_vertices (8 * nVertices);
+    read (interleaved_vertices.data (), sizeof (float), interleaved_vertices.size ());
+    vertices.resize (nVertices);
+    normals.resize (nVertices);
+    texture.resize (nVertices);
+    for (size_t v = 0; v < nVertices; ++v)
+      {
+        const float *const vertex = &interleaved_vertices[8 * v];
+        vertices[v] = vec3 (vertex[0], vertex[1], vertex[2]);
+        normals[v] = vec3 (vertex[3], vertex[4], vertex[5]);
+        texture[v] = vec2 (vertex[6], vertex[7]);
+      }
+  };
+  // turns the welded arrays just read into a triangle list
+  const auto read_indices = [&] (const size_t nIndices, const uint32_t indexSize) {
+    vector<uint32_t> indices (nIndices);
+    if (indexSize == sizeof (uint16_t))
+      {
+        vector<uint16_t> short_indices (nIndices);
+        read (short_indices.data (), sizeof (uint16_t), nIndices);
+        indices.assign (short_indices.begin (), short_indices.end ());
+      }
+    else if (indexSize == sizeof (uint32_t))
+      read (indices.data (), sizeof (uint32_t), nIndices);
+    else
+      {
+        cerr << "[generator] model " << filename << " has indices of " << indexSize << " bytes" << endl;
+        exit (EXIT_FAILURE);
+      }
+
+    model_vector<vec3> welded_vertices, welded_normals;
+    model_vector<vec2> welded_texture;
+    welded_vertices.swap (vertices);
+    welded_normals.swap (normals);
+    welded_texture.swap (texture);
+    vertices.reserve (nIndices);
+    normals.reserve (nIndices);
+    texture.reserve (nIndices);
+    for (const auto index : indices)
+      {
+        if (index >= welded_vertices.size ())
+          {
+            cerr << "[generator] model " << filename << " has an index out of range" << endl;
+            exit (EXIT_FAILURE);
+          }
+        vertices.push_back (welded_vertices[index]);
+        normals.push_back (welded_normals[index]);
+        texture.push_back (welded_texture[index]);
+      }
+  };
+
+  int32_t magic;
+  read (&magic, sizeof (magic), 1);
+  if (magic != MODEL_MAGIC)
+    {
+      if (magic < 0)
+        {
+          cerr << "[generator] " << filename << " is not a .3d file" << endl;
+          exit (EXIT_FAILURE);
+        }
+      read_planar (magic);
+      fclose (fp);
+      return;
+    }
+
+  uint32_t version;
+  read (&version, sizeof (version), 1);
+  const bool bounded = version & MODEL_BOUNDED;
+  version &= ~MODEL_BOUNDED;
+  const auto skip_bounds = [&] {
+    if (bounded)
+      {
+        model_bounds bounds;
+        read (&bounds, sizeof (bounds), 1);
+      }
+  };
+  // the rest of a header, past its magic and version, of size bytes
+  const auto read_header = [&] (auto &header, const size_t size = sizeof (header)) {
+    header.magic = magic;
+    header.version = version;
+    read (&header.version + 1, size - 2 * sizeof (uint32_t), 1);
+    skip_bounds ();
+  };
+
+  if (version == MODEL_VERSION_STREAM)
+    {
+      model_stream_header header;
+      read_header (header);
+      read_planar (header.nVertices);
+    }
+  else if (version == MODEL_VERSION_LOD)
+    {
+      model_lod_header header;
+      read_header (header);
+      model_level_header level;
+      read (&level, sizeof (level), 1);
+      read_planar (level.nVertices);
+      read_indices (level.nIndices, level.indexSize);
+    }
+  else if (version == MODEL_VERSION_QUANTIZED)
+    {
+      model_quantized_header header;
+      read_header (header);
+      vertices.resize (header.nVertices);
+      if (header.attributes & MODEL_QUANTIZED_POSITIONS)
+        {
+          vector<int16_t> positions (4 * header.nVertices);
+          read (positions.data (), sizeof (int16_t), positions.size ());
+          for (size_t v = 0; v < vertices.size (); ++v)
+            for (int axis = 0; axis < 3; ++axis)
+              vertices[v][axis] = header.positionOffset[axis] + header.positionScale * positions[4 * v + axis];
+        }
+      else
+        read (vertices.data (), sizeof (vec3), header.nVertices);
+
+      vector<uint32_t> packed_normals (header.nVertices);
+      read (packed_normals.data (), sizeof (uint32_t), packed_normals.size ());
+      normals.resize (header.nVertices);
+      for (size_t v = 0; v < normals.size (); ++v)
+        for (int axis = 0; axis < 3; ++axis)
+          {
+            // sign extends the 10 bit component, -512 clamps to -1 like OpenGL does
+            auto component = (int32_t) ((packed_normals[v] >> (10 * axis)) & 0x3ff);
+            if (component & 0x200)
+              component -= 0x400;
+            normals[v][axis] = std::max ((float) component / 511.0f, -1.0f);
+          }
+
+      vector<int16_t> texture_coordinates (2 * header.nVertices);
+      read (texture_coordinates.data (), sizeof (int16_t), texture_coordinates.size ());
+      texture.resize (header.nVertices);
+      for (size_t v = 0; v < texture.size (); ++v)
+        for (int axis = 0; axis < 2; ++axis)
+          texture[v][axis] = header.textureOffset[axis] + header.textureScale[axis] * texture_coordinates[2 * v + axis];
+
+      read_indices (header.nIndices, header.indexSize);
+    }
+  else if (version == MODEL_VERSION || version == MODEL_VERSION_INTERLEAVED || version == MODEL_VERSION_CLUSTERS)
+    {
+      // a model_header is a model_cluster_header without its nClusters
+      model_cluster_header header{};
+      read_header (header, version == MODEL_VERSION_CLUSTERS ? sizeof (model_cluster_header) : sizeof (model_header));
+
+      if (version == MODEL_VERSION_INTERLEAVED)
+        read_interleaved (header.nVertices);
+      else
+        read_planar (header.nVertices);
+      // the clusters past the indices only reorder the triangles
+      read_indices (header.nIndices, header.indexSize);
+    }
+  else if (version == MODEL_VERSION_SECTIONS)
+    {
+      // newer writers may grow the header, its headerSize says where the bounds start
+      model_sections_header header;
+      header.magic = magic;
+      header.version = version;
+      read (&header.version + 1, sizeof (header) - 2 * sizeof (uint32_t), 1);
+      fseek (fp, header.headerSize, SEEK_SET);
+      skip_bounds ();
+      vector<model_section> sections (header.nSections);
+      read (sections.data (), sizeof (model_section), sections.size ());
+
+      const model_section *indices = nullptr;
+      for (const auto &section : sections)
+        {
+          fseek (fp, (long) section.offset, SEEK_SET);
+          if (section.type == MODEL_SECTION_POSITIONS)
+            {
+              vertices.resize (header.nVertices);
+              read (vertices.data (), sizeof (vec3), header.nVertices);
+            }
+          else if (section.type == MODEL_SECTION_NORMALS)
+            {
+              normals.resize (header.nVertices);
+              read (normals.data (), sizeof (vec3), header.nVertices);
+            }
+          else if (section.type == MODEL_SECTION_TEXTURE)
+            {
+              texture.resize (header.nVertices);
+              read (texture.data (), sizeof (vec2), header.nVertices);
+            }
+          else if (section.type == MODEL_SECTION_INTERLEAVED)
+            read_interleaved (header.nVertices);
+          else if (section.type == MODEL_SECTION_INDICES)
+            indices = &section;
+          // the clusters, and sections this reader does not know, are skipped
+        }
+      if (!indices || vertices.size () != header.nVertices || normals.size () != header.nVertices
+          || texture.size () != header.nVertices)
+        {
+          cerr << "[generator] model " << filename << " is missing sections" << endl;
+          exit (EXIT_FAILURE);
+        }
+      fseek (fp, (long) indices->offset, SEEK_SET);
+      read_indices (header.nIndices, header.indexSize);
+    }
+  else
+    {
+      cerr << "[generator] " << filename << " has an unknown .3d version(" << version << ")" << endl;
+      exit (EXIT_FAILURE);
+    }
+  fclose (fp);
+}
+
+/*!
+ * A quadric, the sum of the squared distances to a set of planes, as the upper
+ * triangle of its symmetric 4×4 matrix, with the total weight of the planes.
+ */
+struct quadric {
+  //! xx xy xz xw yy yz yw zz zw ww
+  double a[10]{};
+  double weight = 0;
+
+  //! The plane through point with unit normal n, weighted by weight.
+  static quadric plane (const glm::dvec3 n, const glm::dvec3 point, const double weight)
+  {
+    const double d = -glm::dot (n, point);
+    quadric q;
+    const double terms[10] = {n.x * n.x, n.x * n.y, n.x * n.z, n.x * d, n.y * n.y,
+                              n.y * n.z, n.y * d, n.z * n.z, n.z * d, d * d};
+    for (int i = 0; i < 10; ++i)
+      q.a[i] = weight * terms[i];
+    q.weight = weight;
+    return q;
+  }
+
+  quadric &operator+= (const quadric &other)
+  {
+    for (int i = 0; i < 10; ++i)
+      a[i] += other.a[i];
+    weight += other.weight;
+    return *this;
+  }
+
+  //! Root mean square distance from the planes to p.
+  double error (const glm::dvec3 p) const
+  {
+    if (weight <= 0)
+      return 0;
+    const double sum = p.x * p.x * a[0] + 2 * p.x * p.y * a[1] + 2 * p.x * p.z * a[2] + 2 * p.x * a[3]
+                       + p.y * p.y * a[4] + 2 * p.y * p.z * a[5] + 2 * p.y * a[6]
+                       + p.z * p.z * a[7] + 2 * p.z * a[8] + a[9];
+    return std::sqrt (std::max (sum, 0.0) / weight);
+  }
+};
+
+/*!
+ * Weight of the planes that hold border and seam edges in place, relative to
+ * the area weight of a triangle plane (squared edge length against area).
+ */
+const double SIMPLIFY_BORDER_WEIGHT = 10;
+
+//! Collapses may turn a triangle by up to about 75°, further is taken as turning it around.
+const double SIMPLIFY_MIN_TURN_COSINE = 0.25;
+
+//! Positions closer than this, relative to the size of the model, are one position.
+const float SIMPLIFY_WELD_EPSILON = 1e-6f;
+
+//! The cheapest collapse of position from, onto position to, stamped with the version of from it was priced for.
+struct simplify_collapse {
+  float error;
+  uint32_t from, to;
+  uint32_t from_stamp;
+
+  bool operator> (const simplify_collapse &other) const
+  { return error > other.error; }
+};
+
+/*!
+ * Groups the welded vertices by position. Positions within SIMPLIFY_WELD_EPSILON
+ * of the model's size are grouped too, so that the seams of primitives built in
+ * pieces (the sphere's ±π meridian, the edges of Bezier patches) do not open.
+ *
+ * @return the position of every vertex, and the positions in vertex_position.
+ */
+static vector<vec3> simplify_positions (const model_vector<vec3> &vertices, vector<uint32_t> &vertex_position)
+{
+  const model_bounds bounds = model_compute_bounds ((const float *) vertices.data (), vertices.size ());
+  const float epsilon = (bounds.radius > 0 ? bounds.radius : 1) * SIMPLIFY_WELD_EPSILON;
+  // cells are wide enough that most positions only need their own searched
+  const float cell_size = 16 * epsilon;
+
+  struct cell_hash {
+    size_t operator() (const glm::ivec3 &cell) const
+    {
+      uint64_t hash = ((uint64_t) (uint32_t) cell.x << 42) ^ ((uint64_t) (uint32_t) cell.y << 21) ^ (uint32_t) cell.z;
+      hash = (hash ^ (hash >> 31)) * 0x7fb5d329728ea185;
+      return hash ^ (hash >> 27);
+    }
+  };
+  // the positions of a cell are chained through next, from the last one added
+  std::unordered_map<glm::ivec3, uint32_t, cell_hash> cells;
+  cells.reserve (vertices.size ());
+  vector<uint32_t> next;
+
+  vector<vec3> positions;
+  vertex_position.resize (vertices.size ());
+  for (size_t v = 0; v < vertices.size (); ++v)
+    {
+      const vec3 scaled = vertices[v] / cell_size;
+      const glm::ivec3 cell (glm::floor (scaled));
+      glm::ivec3 lo (0, 0, 0), hi (0, 0, 0);
+      for (int axis = 0; axis < 3; ++axis)
+        {
+          const float inside = (scaled[axis] - (float) cell[axis]) * cell_size;
+          lo[axis] = inside <= epsilon ? -1 : 0;
+          hi[axis] = inside >= cell_size - epsilon ? 1 : 0;
+        }
+
+      uint32_t found = UINT32_MAX;
+      for (int dx = lo.x; dx <= hi.x && found == UINT32_MAX; ++dx)
+        for (int dy = lo.y; dy <= hi.y && found == UINT32_MAX; ++dy)
+          for (int dz = lo.z; dz <= hi.z && found == UINT32_MAX; ++dz)
+            {
+              const auto it = cells.find (cell + glm::ivec3 (dx, dy, dz));
+              if (it != cells.end ())
+                for (uint32_t p = it->second; p != UINT32_MAX && found == UINT32_MAX; p = next[p])
+                  if (glm::distance (positions[p], vertices[v]) <= epsilon)
+                    found = p;
+            }
+      if (found == UINT32_MAX)
+        {
+          found = positions.size ();
+          positions.push_back (vertices[v]);
+          const auto [it, inserted] = cells.try_emplace (cell, found);
+          next.push_back (inserted ? UINT32_MAX : it->second);
+          it->second = found;
+        }
+      vertex_position[v] = found;
+    }
+  return positions;
+}
+
+/*!
+ * Simplifies an unindexed triangle list in place (see @ref simplify) until it
+ * has target_ratio of its triangles left, or until the next collapse would cost
+ * more than max_error.
+ *
+ * @return the largest error of the collapses made, in model units.
+ */
+float model_simplify (model_vector<vec3> &vertices,
+                      model_vector<vec3> &normals,
+                      model_vector<vec2> &texture,
+                      const float target_ratio,
+                      const float max_error)
+{
+  vector<uint32_t> indices;
+  model_weld (vertices, normals, texture, indices);
+  vector<uint32_t> vertex_position;
+  const vector<vec3> positions = simplify_positions (vertices, vertex_position);
+  const size_t nPositions = positions.size ();
+
+  // vertices only told apart by their unsnapped positions are one vertex
+  for (size_t v = 0; v < vertices.size (); ++v)
+    vertices[v] = positions[vertex_position[v]];
+  vector<uint32_t> rewelded;
+  model_weld (vertices, normals, texture, rewelded);
+  vector<uint32_t> rewelded_position (vertices.size ());
+  for (size_t v = 0; v < rewelded.size (); ++v)
+    rewelded_position[rewelded[v]] = vertex_position[v];
+  vertex_position.swap (rewelded_position);
+  for (auto &index : indices)
+    index = rewelded[index];
+
+  // triangles folded onto a single position have no area to keep, and repeated
+  // triangles add nothing. The back of a double sided sheet (the same positions
+  // turning the other way) is not simplified, it is rebuilt from its front
+  // through back_vertex once the front is.
+  struct face_hash {
+    size_t operator() (const array<uint32_t, 3> &face) const
+    { return ((size_t) face[0] * 73856093) ^ ((size_t) face[1] * 19349663) ^ ((size_t) face[2] * 83492791); }
+  };
+  // the triangles of a face are chained through next_face, from the last one kept
+  std::unordered_map<array<uint32_t, 3>, uint32_t, face_hash> faces;
+  faces.reserve (indices.size () / 3);
+  vector<uint32_t> next_face;
+  vector<array<uint32_t, 3>> triangles;
+  vector<bool> double_sided;
+  vector<uint32_t> back_vertex (vertices.size (), UINT32_MAX);
+  triangles.reserve (indices.size () / 3);
+  for (size_t i = 0; i < indices.size (); i += 3)
+    {
+      // rotated to start at its smallest position, so equal faces compare equal
+      array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+      const auto first = std::min_element (triangle.begin (), triangle.end (), [&] (const uint32_t a, const uint32_t b) {
+        return vertex_position[a] < vertex_position[b];
+      });
+      std::rotate (triangle.begin (), first, triangle.end ());
+      const uint32_t a = vertex_position[triangle[0]], b = vertex_position[triangle[1]],
+          c = vertex_position[triangle[2]];
+      if (a == b || b == c || c == a)
+        continue;
+
+      const auto same_positions = faces.try_emplace ({a, std::min (b, c), std::max (b, c)}, UINT32_MAX).first;
+      bool keep = true;
+      for (uint32_t f = same_positions->second; f != UINT32_MAX; f = next_face[f])
+        {
+          const auto &front = triangles[f];
+          if (front == triangle)
+            keep = false;
+          else if (!double_sided[f] && vertex_position[front[1]] == c)
+            {
+              // corners pair up as 0-0, 1-2 and 2-1
+              const uint32_t backs[3] = {triangle[0], triangle[2], triangle[1]};
+              bool consistent = true;
+              for (int corner = 0; corner < 3; ++corner)
+                consistent &= back_vertex[front[corner]] == UINT32_MAX || back_vertex[front[corner]] == backs[corner];
+              if (!consistent)
+                continue;
+              for (int corner = 0; corner < 3; ++corner)
+                back_vertex[front[corner]] = backs[corner];
+              double_sided[f] = true;
+              keep = false;
+            }
+          if (!keep)
+            break;
+        }
+      if (keep)
+        {
+          next_face.push_back (same_positions->second);
+          same_positions->second = triangles.size ();
+          triangles.push_back (triangle);
+          double_sided.push_back (false);
+        }
+    }
+  faces = {};
+  const auto target = (size_t) std::ceil ((double) (indices.size () / 3) * target_ratio);
+  const auto position_of = [&] (const uint32_t vertex) { return glm::dvec3 (positions[vertex_position[vertex]]); };
+
+  vector<glm::dvec3> facing (triangles.size ());
+  for (size_t t = 0; t < triangles.size (); ++t)
+    {
+      const auto &triangle = triangles[t];
+      facing[t] = glm::cross (position_of (triangle[1]) - position_of (triangle[0]),
+                              position_of (triangle[2]) - position_of (triangle[0]));
+    }
+
+  vector<vector<uint32_t>> position_triangles (nPositions);
+  for (uint32_t t = 0; t < triangles.size (); ++t)
+    for (const auto vertex : triangles[t])
+      position_triangles[vertex_position[vertex]].push_back (t);
+
+  // every edge used by one triangle, or whose two triangles do not share both
+  // of its vertices (a seam), is held in place by a plane through it
+  vector<quadric> quadrics (nPositions);
+  for (const auto &triangle : triangles)
+    {
+      const glm::dvec3 p[3] = {position_of (triangle[0]), position_of (triangle[1]), position_of (triangle[2])};
+      const glm::dvec3 cross_product = glm::cross (p[1] - p[0], p[2] - p[0]);
+      const double length = glm::length (cross_product);
+      if (length == 0)
+        continue;
+      const glm::dvec3 n = cross_product / length;
+      const quadric plane = quadric::plane (n, p[0], length / 2);
+      for (int corner = 0; corner < 3; ++corner)
+        quadrics[vertex_position[triangle[corner]]] += plane;
+
+      for (int edge = 0; edge < 3; ++edge)
+        {
+          const uint32_t from = triangle[edge], to = triangle[(edge + 1) % 3];
+          const uint32_t from_position = vertex_position[from], to_position = vertex_position[to];
+          int nMatching = 0, nSharing = 0;
+          for (const auto t : position_triangles[from_position])
+            {
+              bool has_from = false, has_to = false, has_to_position = false;
+              for (const auto vertex : triangles[t])
+                {
+                  has_from |= vertex == from;
+                  has_to |= vertex == to;
+                  has_to_position |= vertex_position[vertex] == to_position;
+                }
+              nSharing += has_to_position;
+              nMatching += has_from && has_to;
+            }
+          if (nSharing == 1 || nMatching != nSharing)
+            {
+              const glm::dvec3 e = p[(edge + 1) % 3] - p[edge];
+              const glm::dvec3 m = glm::cross (e, n);
+              const double m_length = glm::length (m);
+              if (m_length == 0)
+                continue;
+              const quadric border = quadric::plane (m / m_length, p[edge], SIMPLIFY_BORDER_WEIGHT * glm::dot (e, e));
+              quadrics[from_position] += border;
+              quadrics[to_position] += border;
+            }
+        }
+    }
+
+  // every position is queued with its cheapest collapse, and priced again
+  // whenever its neighbourhood changes, which outdates its earlier entries
+  vector<uint32_t> stamps (nPositions, 0);
+  vector<vector<uint32_t>> refused (nPositions);
+  vector<bool> alive_triangles (triangles.size (), true);
+  std::priority_queue<simplify_collapse, vector<simplify_collapse>, std::greater<>> queue;
+  vector<simplify_collapse> queued (nPositions, {0, 0, UINT32_MAX, 0});
+  const auto price = [&] (const uint32_t position) {
+    double cheapest = INFINITY;
+    uint32_t cheapest_to = UINT32_MAX;
+    for (const auto t : position_triangles[position])
+      if (alive_triangles[t])
+        for (const auto vertex : triangles[t])
+          {
+            const uint32_t other = vertex_position[vertex];
+            if (other == position || std::find (refused[position].begin (), refused[position].end (), other) != refused[position].end ())
+              continue;
+            const double cost = quadrics[position].error (glm::dvec3 (positions[other]));
+            if (cost < cheapest)
+              {
+                cheapest = cost;
+                cheapest_to = other;
+              }
+          }
+    // an unchanged collapse keeps its entry
+    auto &entry = queued[position];
+    if (cheapest_to == entry.to && (float) cheapest == entry.error)
+      return;
+    entry = {(float) cheapest, position, cheapest_to, ++stamps[position]};
+    if (cheapest_to != UINT32_MAX)
+      queue.push (entry);
+  };
+
+  size_t nTriangles = triangles.size () + std::count (double_sided.begin (), double_sided.end (), true);
+  float error = 0;
+  vector<std::pair<uint32_t, uint32_t>> partner;
+  vector<std::pair<uint32_t, int>> from_neighbours;
+  vector<uint32_t> shared, moved;
+  const auto find = [] (auto &pairs, const uint32_t key) {
+    return std::find_if (pairs.begin (), pairs.end (), [key] (const auto &pair) { return pair.first == key; });
+  };
+
+  // checks the collapse of from onto to, gathering the triangles of the edge,
+  // which vanish, the other triangles of from, which move, and the partners
+  const auto collapsible = [&] (const uint32_t from, const uint32_t to) {
+    shared.clear ();
+    moved.clear ();
+    partner.clear ();
+    from_neighbours.clear ();
+    bool valid = true;
+    for (const auto t : position_triangles[from])
+      {
+        if (!alive_triangles[t])
+          continue;
+        uint32_t from_vertex = UINT32_MAX, to_vertex = UINT32_MAX;
+        for (const auto vertex : triangles[t])
+          {
+            const uint32_t position = vertex_position[vertex];
+            if (position == from)
+              from_vertex = vertex;
+            else
+              {
+                const auto it = find (from_neighbours, position);
+                if (it == from_neighbours.end ())
+                  from_neighbours.emplace_back (position, 1);
+                else
+                  ++it->second;
+                if (position == to)
+                  to_vertex = vertex;
+              }
+          }
+        if (to_vertex == UINT32_MAX)
+          moved.push_back (t);
+        else
+          {
+            // every vertex of from must have a single partner among the vertices of to
+            shared.push_back (t);
+            const auto it = find (partner, from_vertex);
+            if (it == partner.end ())
+              partner.emplace_back (from_vertex, to_vertex);
+            else
+              valid &= it->second == to_vertex;
+          }
+      }
+    // and the backs of the moved triangles need the back of that partner
+    for (size_t m = 0; valid && m < moved.size (); ++m)
+      for (const auto vertex : triangles[moved[m]])
+        if (vertex_position[vertex] == from)
+          {
+            const auto it = find (partner, vertex);
+            valid &= it != partner.end () && (!double_sided[moved[m]] || back_vertex[it->second] != UINT32_MAX);
+          }
+    // a manifold edge has one or two triangles, and a vertex on a border
+    // (a neighbour it shares a single triangle with) only slides along it
+    valid &= !shared.empty () && shared.size () <= 2;
+    if (valid && shared.size () == 2)
+      for (const auto &[neighbour, count] : from_neighbours)
+        valid &= count == 2;
+    if (!valid)
+      return false;
+
+    // link condition: from and to only share the neighbours of the edge's triangles
+    size_t nCommon = 0;
+    for (const auto t : position_triangles[to])
+      if (alive_triangles[t])
+        for (const auto vertex : triangles[t])
+          {
+            const auto it = find (from_neighbours, vertex_position[vertex]);
+            if (it != from_neighbours.end () && it->first != to && it->second > 0)
+              {
+                ++nCommon;
+                it->second = 0;
+              }
+          }
+    if (nCommon != shared.size ())
+      return false;
+
+    // the moved triangles must keep facing about the same way, and small turns
+    // must not add up to turning them around
+    for (const auto t : moved)
+      {
+        glm::dvec3 before[3], after[3];
+        for (int corner = 0; corner < 3; ++corner)
+          {
+            before[corner] = position_of (triangles[t][corner]);
+            after[corner] = vertex_position[triangles[t][corner]] == from ? glm::dvec3 (positions[to]) : before[corner];
+          }
+        const glm::dvec3 normal_before = glm::cross (before[1] - before[0], before[2] - before[0]);
+        const glm::dvec3 normal_after = glm::cross (after[1] - after[0], after[2] - after[0]);
+        if (glm::dot (normal_before, normal_after) <= SIMPLIFY_MIN_TURN_COSINE * glm::length (normal_before) * glm::length (normal_after)
+            || glm::dot (facing[t], normal_after) <= 0)
+          return false;
+      }
+    return true;
+  };
+
+  // a refused collapse may be allowed once its neighbourhood changed, without
+  // either of its positions being priced again, so the queue is rebuilt from
+  // every position left for as long as a pass collapses any
+  for (bool progress = true, over_error = false; progress && !over_error && nTriangles > target;)
+    {
+      progress = false;
+      queue = {};
+      for (uint32_t p = 0; p < nPositions; ++p)
+        {
+          refused[p].clear ();
+          queued[p].to = UINT32_MAX;
+          price (p);
+        }
+
+      while (nTriangles > target && !queue.empty ())
+        {
+          const simplify_collapse collapse = queue.top ();
+          if (collapse.error > max_error)
+            {
+              over_error = true;
+              break;
+            }
+          queue.pop ();
+          const uint32_t from = collapse.from, to = collapse.to;
+          if (collapse.from_stamp != stamps[from])
+            continue;
+          if (!collapsible (from, to))
+            {
+              refused[from].push_back (to);
+              price (from);
+              continue;
+            }
+
+          for (const auto t : shared)
+            {
+              alive_triangles[t] = false;
+              nTriangles -= double_sided[t] ? 2 : 1;
+            }
+          auto &to_triangles = position_triangles[to];
+          to_triangles.erase (std::remove_if (to_triangles.begin (), to_triangles.end (),
+                                              [&] (const uint32_t t) { return !alive_triangles[t]; }),
+                              to_triangles.end ());
+          for (const auto t : moved)
+            {
+              for (auto &vertex : triangles[t])
+                if (vertex_position[vertex] == from)
+                  vertex = find (partner, vertex)->second;
+              to_triangles.push_back (t);
+            }
+          vector<uint32_t> ().swap (position_triangles[from]);
+          vector<uint32_t> ().swap (refused[from]);
+          quadrics[to] += quadrics[from];
+          ++stamps[from];
+          queued[from].to = UINT32_MAX;
+          error = std::max (error, collapse.error);
+          progress = true;
+
+          // to has a new quadric, and the neighbours of from lost it (the other
+          // neighbours of to keep their triangles, and their prices)
+          refused[to].clear ();
+          price (to);
+          for (const auto &[neighbour, count] : from_neighbours)
+            if (neighbour != to)
+              {
+                refused[neighbour].clear ();
+                price (neighbour);
+              }
+        }
+    }
+
+  model_vector<vec3> welded_vertices, welded_normals;
+  model_vector<vec2> welded_texture;
+  welded_vertices.swap (vertices);
+  welded_normals.swap (normals);
+  welded_texture.swap (texture);
+  vertices.reserve (3 * nTriangles);
+  normals.reserve (3 * nTriangles);
+  texture.reserve (3 * nTriangles);
+  for (size_t t = 0; t < triangles.size (); ++t)
+    if (alive_triangles[t])
+      {
+        const auto &front = triangles[t];
+        vector<uint32_t> corners (front.begin (), front.end ());
+        if (double_sided[t])
+          corners.insert (corners.end (), {back_vertex[front[0]], back_vertex[front[2]], back_vertex[front[1]]});
+        for (const auto vertex : corners)
+          {
+            vertices.push_back (welded_vertices[vertex]);
+            normals.push_back (welded_normals[vertex]);
+            texture.push_back (welded_texture[vertex]);
+          }
+      }
+  return error;
+}
+
+//!@} end of group simplify
+
+/*! @addtogroup kernels
+ * @{*/
+
+/*!
+ * out[i] = factor ⋅ table[i] for i ∈ {0,...,n-1}.
+ *
+ * Uses SSE, which every x86-64 target has, with a scalar loop for the
+ * remainder and for other architectures.
+ */
+static void scale_table (const float *const table, const float factor, float *const out, const size_t n)
+{
+  size_t i = 0;
+#if defined(__SSE__)
+  const __m128 factor4 = _mm_set1_ps (factor);
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps (out + i, _mm_mul_ps (factor4, _mm_loadu_ps (table + i)));
+#endif
+  for (; i < n; ++i)
+    out[i] = factor * table[i];
+}
+
+//! Sine and cosine of the angles first + k⋅step, k ∈ {0,...,n}.
+struct trig_table {
+  vector<float> sin;
+  vector<float> cos;
+};
+
+static trig_table get_trig_table (const float first, const float step, const unsigned int n)
+{
+  trig_table table;
+  table.sin.reserve (n + 1);
+  table.cos.reserve (n + 1);
+  for (unsigned int k = 0; k <= n; ++k)
+    {
+      const float angle = first + step * (float) k;
+      table.sin.push_back ((float) sin (angle));
+      table.cos.push_back ((float) cos (angle));
+    }
+  return table;
+}
+
+//!@} end of group kernels
+
+/*! @addtogroup model
+ * @{*/
+
+/*!
+ * Fills nRows rows of a model, rowVertices vertices each, in parallel (see
+ * parallel_for). Each row is filled by fill(row, vertex, normal, texcoord)
+ * into its own slice of the output, already allocated, so the result does not
+ * depend on the number of threads. With a sink, the rows are filled a chunk at
+ * a time. prepare(first_row, nChunkRows) is called before each chunk, to build
+ * what its rows share.
+ */
+static void model_fill_rows (const size_t nRows,
+                             const size_t rowVertices,
+                             model_vector<vec3> &vertices,
+                             model_vector<vec3> &normals,
+                             model_vector<vec2> &texture,
+                             model_sink *const sink,
+                             const std::function<void (size_t, size_t)> &prepare,
+                             const std::function<void (size_t, vec3 *, vec3 *, vec2 *)> &fill)
+{
+  const size_t chunkRows = sink ? std::max<size_t> (1, sink->chunkVertices / std::max<size_t> (1, rowVertices)) : nRows;
+  for (size_t first_row = 0; first_row < nRows; first_row += chunkRows)
+    {
+      const size_t nChunkRows = std::min (chunkRows, nRows - first_row);
+      const size_t offset = vertices.size ();
+      const size_t nVertices = offset + nChunkRows * rowVertices;
+      vertices.resize (nVertices);
+      normals.resize (nVertices);
+      texture.resize (nVertices);
+
+      prepare (first_row, nChunkRows);
+      parallel_for (nChunkRows, [&] (const size_t row) {
+        const size_t first = offset + row * rowVertices;
+        fill (first_row + row, &vertices[first], &normals[first], &texture[first]);
+      });
+      model_sink_flush (sink, vertices, normals, texture);
+    }
+  model_sink_flush (sink, vertices, normals, texture, true);
+}
+
+//! model_fill_rows of rows that share nothing.
+static void model_fill_rows (const size_t nRows,
+                             const size_t rowVertices,
+                             model_vector<vec3> &vertices,
+                             model_vector<vec3> &normals,
+                             model_vector<vec2> &texture,
+                             model_sink *const sink,
+                             const std::function<void (size_t, vec3 *, vec3 *, vec2 *)> &fill)
+{
+  model_fill_rows (nRows, rowVertices, vertices, normals, texture, sink, [] (size_t, size_t) {}, fill);
+}
+
+/*! @addtogroup plane
+* @{*/
+void model_plane_vertices (const float length,
+                           const unsigned int divisions,
+                           model_vector<vec3> &vertices,
+                           model_vector<vec3> &normals,
+                           model_vector<vec2> &texture,
+                           model_sink *const sink = nullptr)
+{
+  const float o = -length / 2.0f;
+  const float d = length / (float) divisions;
+
+  // a row of quads per uidiv1
+  model_fill_rows (divisions, 12 * (size_t) divisions, vertices, normals, texture, sink,
+                   [&] (const size_t row, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    const auto uidiv1 = (unsigned int) row + 1;
+    for (unsigned int uidiv2 = 1; uidiv2 <= divisions; ++uidiv2)
+      {
+        auto const fdiv1 = (float) uidiv1;
+        auto const fdiv2 = (float) uidiv2;
+        auto const fdivisions = (float) divisions;
+
+        for (auto e : {
+            array<float, 2>{-1, -1},//P1
+            array<float, 2>{-1, 0},//P1'z
+            array<float, 2>{0, -1},//P1'x
+
+            array<float, 2>{0, -1},//P1'x
+            array<float, 2>{-1, 0},//P1'z
+            array<float, 2>{0, 0}})//P2
+          {
+            *vertex++ = vec3 (o + d * (fdiv1 + e[0]), 0, o + d * (fdiv2 + e[1]));
+            *normal++ = vec3 (0, 1, 0);
+            *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+          }
+
+
+        /*Cull face*/
+        for (auto e : {
+            array<float, 2>{-1.0f, 0.0f},
+            array<float, 2>{-1.0f, -1.0f},
+            array<float, 2>{0.0f, -1.0f},
+
+            array<float, 2>{-1.0f, 0.0f},
+            array<float, 2>{0.0f, -1.0f},
+            array<float, 2>{0.0f, 0.0f}})
+          {
+            *vertex++ = vec3 (o + d * (fdiv1 + e[0]), 0, o + d * (fdiv2 + e[1]));
+            *normal++ = vec3 (0, -1, 0);
+            *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+          }
+      }
+  });
+}
+
+static inline size_t model_plane_nVertices (const unsigned int divisions)
+{ return (size_t) divisions * divisions * 12; }
+
+//!@} end of group plane
+
+/*! @addtogroup cube
+* @{*/
+void model_cube_vertices (const float length,
+                          const unsigned int divisions,
+                          model_vector<vec3> &vertices,
+                          model_vector<vec3> &normals,
+                          model_vector<vec2> &texture,
+                          model_sink *const sink = nullptr)
+{
+  const float o = -length / 2.0f;
+  const float d = length / (float) divisions;
+
+  // a row of quads per uidiv1, on every face
+  model_fill_rows (divisions, 36 * (size_t) divisions, vertices, normals, texture, sink,
+                   [&] (const size_t row, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    const auto uidiv1 = (unsigned int) row + 1;
+    for (unsigned int uidiv2 = 1; uidiv2 <= divisions; uidiv2++)
+      {
+        auto const fdiv1 = (float) uidiv1;
+        auto const fdiv2 = (float) uidiv2;
+        auto const fdivisions = (float) divisions;
+
+        // y+
+        for (auto e : {
+            array<float, 2>{-1, -1}, //P1
+            array<float, 2>{-1, 0}, //P1'z
+            array<float, 2>{0, -1}, //P1'x
+
+            array<float, 2>{0, -1}, //P1'x
+            array<float, 2>{-1, 0}, //P1'z
+            array<float, 2>{0, 0}   //P2
+        })
+          {
+            *vertex++ = vec3 (o + d * (fdiv1 + e[0]), -o, o + d * (fdiv2 + e[1]));
+            *normal++ = vec3 (0, 1, 0);
+            *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+          }
+
+        // y-
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o, o + d * fdiv2); //P1'z
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o, o + d * (fdiv2 - 1)); //P1
+        *vertex++ = vec3 (o + d * fdiv1, o, o + d * (fdiv2 - 1)); //P1'x
+
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o, o + d * fdiv2); //P1'z
+        *vertex++ = vec3 (o + d * fdiv1, o, o + d * (fdiv2 - 1)); //P1'x
+        *vertex++ = vec3 (o + d * fdiv1, o, o + d * fdiv2); //P2
+
+        for (int k = 0; k < 6; ++k)
+          *normal++ = vec3 (0, -1, 0);
+        for (auto e : {
+            vec2 (-1.0f, 0.0f),
+            vec2 (-1.0f, -1.0f),
+            vec2 (0.0f, -1.0f),
+
+            vec2 (-1.0f, 0.0f),
+            vec2 (0.0f, -1.0f),
+            vec2 (0.0f, 0.0f)})
+          *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+
+
+        // x-
+        *vertex++ = vec3 (o, o + d * (fdiv1 - 1), o + d * (fdiv2 - 1)); //P1
+        *vertex++ = vec3 (o, o + d * (fdiv1 - 1), o + d * fdiv2); //P1'z
+        *vertex++ = vec3 (o, o + d * fdiv1, o + d * (fdiv2 - 1)); //P1'x
+
+        *vertex++ = vec3 (o, o + d * fdiv1, o + d * (fdiv2 - 1)); //P1'x
+        *vertex++ = vec3 (o, o + d * (fdiv1 - 1), o + d * fdiv2); //P1'z
+        *vertex++ = vec3 (o, o + d * fdiv1, o + d * fdiv2); //P2
+
+        for (int k = 0; k < 6; ++k)
+          *normal++ = vec3 (-1, 0, 0);
+
+        for (auto e : {
+            vec2 (-1.0f, -1.0f),
+            vec2 (-1.0f, 0.0f),
+            vec2 (0.0f, -1.0f),
+
+            vec2 (0.0f, -1.0f),
+            vec2 (-1.0f, 0.0f),
+            vec2 (0.0f, 0.0f)})
+          *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+
+
+        // x+
+        *vertex++ = vec3 (-o, o + d * (fdiv1 - 1), o + d * fdiv2); //P1'z
+        *vertex++ = vec3 (-o, o + d * (fdiv1 - 1), o + d * (fdiv2 - 1)); //P1
+        *vertex++ = vec3 (-o, o + d * fdiv1, o + d * (fdiv2 - 1)); //P1'x
+
+        *vertex++ = vec3 (-o, o + d * (fdiv1 - 1), o + d * fdiv2); //P1'z
+        *vertex++ = vec3 (-o, o + d * fdiv1, o + d * (fdiv2 - 1)); //P1'x
+        *vertex++ = vec3 (-o, o + d * fdiv1, o + d * fdiv2); //P2
+
+        for (int k = 0; k < 6; ++k)
+          *normal++ = vec3 (1, 0, 0);
+
+        for (auto e : {
+            vec2 (-1.0f, 0.0f),
+            vec2 (-1.0f, -1.0f),
+            vec2 (0.0f, -1.0f),
+
+            vec2 (-1.0f, 0.0f),
+            vec2 (0.0f, -1.0f),
+            vec2 (0.0f, 0.0f)})
+          *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+
+
+        // z-
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o + d * (fdiv2 - 1), o); //P1
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o + d * fdiv2, o); //P1'z
+        *vertex++ = vec3 (o + d * fdiv1, o + d * (fdiv2 - 1), o); //P1'x
+
+        *vertex++ = vec3 (o + d * fdiv1, o + d * (fdiv2 - 1), o); //P1'x
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o + d * fdiv2, o); //P1'z
+        *vertex++ = vec3 (o + d * fdiv1, o + d * fdiv2, o); //P2
+
+        for (auto e : {
+            vec2 (-1.0f, -1.0f),//P1
+            vec2 (-1.0f, 0.0f),//P1'z
+            vec2 (0.0f, -1.0f),//P1'x
+
+            vec2 (0.0f, -1.0f),//P1'x
+            vec2 (-1.0f, 0.0f),//P1'z
+            vec2 (0.0f, 0.0f)//P2
+        })
+          {
+            *normal++ = vec3 (0, 0, -1);
+            *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+          }
+
+
+
+        // z+
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o + d * fdiv2, -o); //P1'z
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o + d * (fdiv2 - 1), -o); //P1
+        *vertex++ = vec3 (o + d * fdiv1, o + d * (fdiv2 - 1), -o); //P1'x
+
+        *vertex++ = vec3 (o + d * (fdiv1 - 1), o + d * fdiv2, -o); //P1'z
+        *vertex++ = vec3 (o + d * fdiv1, o + d * (fdiv2 - 1), -o); //P1'x
+        *vertex++ = vec3 (o + d * fdiv1, o + d * fdiv2, -o); //P2
+
+        for (int k = 0; k < 6; ++k)
+          *normal++ = vec3 (0, 0, 1);
+
+        for (auto e : {
+            vec2 (-1.0f, 0.0f),
+            vec2 (-1.0f, -1.0f),
+            vec2 (0.0f, -1.0f),
+
+            vec2 (-1.0f, 0.0f),
+            vec2 (0.0f, -1.0f),
+            vec2 (0.0f, 0.0f)
+        })
+          *texcoord++ = vec2 ((fdiv1 + e[0]) / fdivisions, (fdiv2 + e[1]) / fdivisions);
+      }
+  });
+}
+
+static inline size_t model_cube_nVertices (const unsigned int divisions)
+{ return (size_t) divisions * divisions * 36; }
+
+
+//!@} end of group cube
+
+/*! @addtogroup cone
+* @{*/
+
+/*!
+ * \f{aligned}{
+ * x &= r⋅\frac{h}{\textrm{height}} ⋅ \cos(θ)\\[2em]
+ * y &= h + \textrm{height}\\[2em]
+ * z &= r⋅\frac{h}{\textrm{height}} ⋅ \sin(θ)
+ * \f}\n
+ *
+ * \f{aligned}{
+ *  r &≥ 0\\
+ *  θ &∈ \left\{-π      + i⋅s : s = \frac{2π}{\textrm{slices}}      ∧ i ∈ \{0,...,\textrm{slices}\} \right\}\\
+ *  h &∈ \left\{- \textrm{height} + j⋅t : t =  \frac{\textrm{height}}{\textrm{stacks}} ∧ j ∈ \{0,...,\textrm{stacks}\} \right\}
+ *  \f}
+ *
+ *  See the [3d model](https://www.math3d.org/7oeSkmuns).
+ */
+
+template<typename T>
+    requires arithmetic<T>
+void model_cone_vertices (const T radius,
+                          const T height,
+                          const unsigned int slices,
+                          const unsigned int stacks,
+                          model_vector<vec3> &vertices,
+                          model_vector<vec3> &normals,
+                          model_vector<vec2> &texture,
+                          model_sink *const sink = nullptr)
+{
+  /*
+     x = r ⋅ (h/height) ⋅ cos(θ)
+     y = 2 ⋅ (height + h)
+     z = r ⋅ (h/height) ⋅ sin(θ)
+
+     r ≥ 0
+     θ ∈ {-π      + i⋅s : s = 2π/slices      ∧ i ∈ {0,...,slices} }
+     h ∈ {-height + j⋅t : t = height/stacks ∧ j ∈ {0,...,stacks} }
+
+     check:
+         1. https://www.math3d.org/7oeSkmuns
+
+     The points of the (slices + 1) × (stacks + 1) grid are computed a column
+     (fixed θ) at a time, from a table of cos(θ) and sin(θ) and one of
+     r ⋅ (h/height). The columns are built once, in parallel, and each slice's
+     triangles are assembled from its two columns.
+   */
+
+  const T s = 2 * M_PI / (float) slices;
+  const T t = height / (float) stacks;
+
+  const T theta_0 = -M_PI;
+  const T h_0 = -height;
+
+  auto const fslices = (float) slices;
+  auto const fstacks = (float) stacks;
+
+  const unsigned int side = stacks + 1;
+  const trig_table theta = get_trig_table (theta_0, s, slices);
+  vector<float> radii (side), ys (side);
+  for (unsigned int stack = 0; stack <= stacks; ++stack)
+    {
+      const T h = h_0 + t * (float) stack;
+      radii[stack] = radius * h / height;
+      ys[stack] = height + h;
+    }
+
+  // the columns a chunk of slices spans, the first one at first_column
+  size_t first_column = 0;
+  model_vector<vec3> column_points;
+  const auto build_columns = [&] (const size_t first_slice, const size_t nSlices) {
+    first_column = first_slice;
+    column_points.resize ((nSlices + 1) * side);
+    parallel_for (nSlices + 1, [&] (const size_t c) {
+      const size_t slice = first_slice + c;
+      vector<float> xs (side), zs (side);
+      scale_table (radii.data (), theta.cos[slice], xs.data (), side);
+      scale_table (radii.data (), theta.sin[slice], zs.data (), side);
+      vec3 *const points = &column_points[c * side];
+      for (unsigned int stack = 0; stack <= stacks; ++stack)
+        points[stack] = vec3 (xs[stack], ys[stack], zs[stack]);
+    });
+  };
+
+  // a row of quads per slice, between the columns at slice - 1 and slice
+  model_fill_rows (slices, 9 * (size_t) stacks, vertices, normals, texture, sink, build_columns,
+                   [&] (const size_t row, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    const auto slice = (unsigned int) row + 1;
+    const vec3 *const left = &column_points[(row - first_column) * side];
+    const vec3 *const columns[2] = {left, left + side};
+
+    for (unsigned int stack = 1; stack <= stacks; ++stack)
+      {
+        auto const fslice = (float) slice;
+        auto const fstack = (float) stack;
+
+        //base
+        *vertex++ = vec3 (0, 0, 0); //O
+        *texcoord++ = vec2 (0, 0);
+        *normal++ = vec3 (0, -1, 0);
+        for (auto e : {
+            -1,//P1
+            0 //P2
+        })
+          {
+            *vertex++ = columns[1 + e][0]; //P1
+            *normal++ = vec3 (0, -1, 0);
+          }
+
+        *texcoord++ = vec2 (-1, 0);
+        *texcoord++ = vec2 (0, 0);
+
+        int q = 0;
+        for (auto e : {
+            array<int, 2>{0, -1},
+            array<int, 2>{-1, 0},
+            array<int, 2>{0, 0},
+
+            array<int, 2>{0, -1},
+            array<int, 2>{-1, -1},
+            array<int, 2>{-1, 0},
+        })
+          {
+            *vertex++ = columns[1 + e[0]][stack + e[1]];
+            if (q % 3 == 2)
+              {
+                const auto P1 = vertex[-2];
+                const auto P2 = vertex[-3];
+                const auto P1_prime = vertex[-1];
+                for (auto _ = 0; _ < 3; ++_)
+                  *normal++ = vec3 (normalize (cross (P2 - P1_prime, P1 - P1_prime)));
+              }
+
+            *texcoord++ = vec2 (fslice / fslices, fstack / fstacks);
+            ++q;
+          }
+      }
+  });
+}
+
+static inline size_t model_cone_nVertices (const unsigned int stacks, const unsigned int slices)
+{
+  return (size_t) slices * stacks * 9;
+}
+
+
+//!@} end of group cone
+
+/*! @addtogroup sphere
+* @{*/
+
+static inline size_t model_sphere_nVertices (const unsigned int slices, const unsigned int stacks)
+{
+  return (size_t) slices * stacks * 6;
+}
+
+void model_sphere_vertices (const float r,
+                            const unsigned int slices,
+                            const unsigned int stacks,
+                            model_vector<vec3> &vertices,
+                            model_vector<vec3> &normals,
+                            model_vector<vec2> &texture,
+                            model_sink *const sink = nullptr)
+{
+  /*
+      x = r ⋅ sin(θ)cos(φ)
+      y = r ⋅ sin(φ)
+      z = r ⋅ cos(θ)cos(φ)
+
+      r ≥ 0
+      θ ∈ {-π +   i⋅s : s = 2π/slices ∧ i ∈ {0,...,slices} }
+      ϕ ∈ {-π/2 + j⋅t : t =  π/stacks ∧ j ∈ {0,...,stacks} }
+
+      check
+          1. https://www.math3d.org/EumEEZBKe
+          2. https://www.math3d.org/zE4n6xayX
+
+      The points and normals of the (slices + 1) × (stacks + 1) grid are
+      computed a column (fixed θ) at a time, from tables of the sines and
+      cosines of θ and φ. The columns are built once, in parallel, and each
+      slice's triangles are assembled from its two columns.
+   */
+
+  const float s = 2.0f * (float) M_PI / (float) slices;
+  const float t = M_PI / (float) stacks;
+  const float theta = -M_PI;
+  const float phi = -M_PI / 2.0f;
+
+  auto fslices = (float) slices;
+  auto fstacks = (float) stacks;
+
+  const unsigned int side = stacks + 1;
+  const trig_table theta_table = get_trig_table (theta, s, slices);
+  const trig_table phi_table = get_trig_table (phi, t, stacks);
+  vector<float> r_cos_phi (side);
+  scale_table (phi_table.cos.data (), r, r_cos_phi.data (), side);
+
+  // the columns a chunk of slices spans, the first one at first_column
+  size_t first_column = 0;
+  model_vector<vec3> column_points, column_normals;
+  const auto build_columns = [&] (const size_t first_slice, const size_t nSlices) {
+    first_column = first_slice;
+    column_points.resize ((nSlices + 1) * side);
+    column_normals.resize ((nSlices + 1) * side);
+    parallel_for (nSlices + 1, [&] (const size_t c) {
+      const size_t slice = first_slice + c;
+      vector<float> xs (side), zs (side), nxs (side), nzs (side);
+      scale_table (r_cos_phi.data (), theta_table.sin[slice], xs.data (), side);
+      scale_table (r_cos_phi.data (), theta_table.cos[slice], zs.data (), side);
+      scale_table (phi_table.cos.data (), theta_table.sin[slice], nxs.data (), side);
+      scale_table (phi_table.cos.data (), theta_table.cos[slice], nzs.data (), side);
+      vec3 *const points = &column_points[c * side];
+      vec3 *const point_normals = &column_normals[c * side];
+      for (unsigned int stack = 0; stack <= stacks; ++stack)
+        {
+          const float sin_phi = phi_table.sin[stack];
+          points[stack] = vec3 (xs[stack], r * sin_phi, zs[stack]);
+          point_normals[stack] = vec3 (nxs[stack], sin_phi, nzs[stack]);
+        }
+    });
+  };
+
+  // a row of quads per slice, between the columns at slice - 1 and slice
+  model_fill_rows (slices, 6 * (size_t) stacks, vertices, normals, texture, sink, build_columns,
+                   [&] (const size_t row, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    const auto slice = (unsigned int) row + 1;
+    const size_t left = (row - first_column) * side;
+    const vec3 *const points[2] = {&column_points[left], &column_points[left + side]};
+    const vec3 *const point_normals[2] = {&column_normals[left], &column_normals[left + side]};
+
+    for (unsigned int stack = 1; stack <= stacks; ++stack)
+      {
+        auto fslice = (float) slice;
+        auto fstack = (float) stack;
+
+        *texcoord++ = vec2 ((fslice - 1) / fslices, fstack / fstacks); // P1'
+        *texcoord++ = vec2 (fslice / fslices, (fstack - 1) / fstacks); // P2
+        *texcoord++ = vec2 (fslice / fslices, fstack / fstacks); // P2'
+
+        *texcoord++ = vec2 ((fslice - 1) / fslices, (fstack - 1) / fstacks); // P1
+        *texcoord++ = vec2 (fslice / fslices, (fstack - 1) / fstacks); // P2
+        *texcoord++ = vec2 ((fslice - 1) / fslices, fstack / fstacks); // P1'
+
+        // (column, stack), column 0 being the left one
+        for (const auto [right, k] : {
+            array<unsigned int, 2>{0, stack}, // P1'
+            array<unsigned int, 2>{1, stack - 1}, // P2
+            array<unsigned int, 2>{1, stack}, // P2'
+
+            array<unsigned int, 2>{0, stack - 1}, // P1
+            array<unsigned int, 2>{1, stack - 1}, // P2
+            array<unsigned int, 2>{0, stack} // P1'
+        })
+          {
+            *vertex++ = points[right][k];
+            *normal++ = point_normals[right][k];
+          }
+      }
+  });
+}
+
+//!@} end of group sphere
+
+/*! @addtogroup sphereMesh
+ * @{
+ * Spheres tessellated from a polyhedron, an icosahedron or a cube, whose
+ * triangles all have about the same size. The UV sphere spends most of its
+ * triangles near the poles, where they degenerate into slivers. These meshes
+ * spread them over the whole surface and have no slivers, and the cubesphere
+ * reaches a given accuracy with about a quarter fewer vertices and triangles
+ * (see the table below). Texture coordinates are the UV sphere's, so the same
+ * equirectangular textures apply.
+ *
+ * Largest distance between a unit sphere and its mesh, with the vertices and
+ * triangles written once welded. The UV sphere's slivers are the triangles
+ * with two vertices at a pole, 2 ⋅ slices of them:
+ * @code{.unparsed}
+ *  model               vertices  triangles   error    slivers
+ *  sphere 1 16 8            153        256   0.0374        32
+ *  sphere 1 32 16           561       1024   0.0096        64
+ *  sphere 1 64 32          2145       4096   0.0024       128
+ *  sphere 1 128 64         8385      16384   0.0006       256
+ *  icosphere 1 1             67         80   0.0658
+ *  icosphere 1 2            214        320   0.0178
+ *  icosphere 1 3            735       1280   0.0045
+ *  icosphere 1 4           2747       5120   0.0011
+ *  icosphere 1 5          10615      20480   0.0003
+ *  cubesphere 1 4           119        192   0.0349
+ *  cubesphere 1 8           415        768   0.0094
+ *  cubesphere 1 16         1583       3072   0.0024
+ *  cubesphere 1 32         6223      12288   0.0006
+ *  cubesphere 1 64        24719      49152   0.0002
+ * @endcode
+ * Vertices on the texture seam and at the poles are written once per texture
+ * coordinate, so they count more than once. The poles are vertices of the
+ * icosphere from one subdivision on, and of the cubesphere when its divisions
+ * are even. Otherwise the triangles around a pole stretch the texture.
+ */
+
+//! The texture coordinate of a point of the unit sphere, as model_sphere_vertices lays them out.
+static vec2 model_sphere_texture (const vec3 point)
+{
+  return vec2 ((atan2f (point.x, point.z) + (float) M_PI) / (2 * (float) M_PI),
+               (asinf (std::clamp (point.y, -1.0f, 1.0f)) + (float) M_PI / 2) / (float) M_PI);
+}
+
+/*!
+ * Writes a triangle of a sphere of radius r from three points of the unit
+ * sphere, counterclockwise seen from outside. A triangle across the seam at
+ * θ = ±π has 1 added to its texture coordinates near 0, textures repeat, and a
+ * vertex at a pole, where θ is undefined, takes the mean θ of the other two.
+ */
+static void model_sphere_triangle (const float r,
+                                   const array<vec3, 3> &points,
+                                   vec3 *&vertex,
+                                   vec3 *&normal,
+                                   vec2 *&texcoord)
+{
+  array<vec2, 3> uvs{};
+  array<bool, 3> pole{};
+  float lo = 1, hi = 0;
+  for (int k = 0; k < 3; ++k)
+    {
+      uvs[k] = model_sphere_texture (points[k]);
+      pole[k] = fabsf (points[k].x) < 1e-6f && fabsf (points[k].z) < 1e-6f;
+      if (!pole[k])
+        {
+          lo = std::min (lo, uvs[k].x);
+          hi = std::max (hi, uvs[k].x);
+        }
+    }
+  for (int k = 0; k < 3; ++k)
+    if (!pole[k] && hi - lo > 0.5f && uvs[k].x < 0.5f)
+      uvs[k].x += 1;
+  for (int k = 0; k < 3; ++k)
+    if (pole[k])
+      {
+        float sum = 0;
+        int n = 0;
+        for (int other = 0; other < 3; ++other)
+          if (!pole[other])
+            {
+              sum += uvs[other].x;
+              ++n;
+            }
+        uvs[k].x = n ? sum / (float) n : 0.5f;
+      }
+  for (int k = 0; k < 3; ++k)
+    {
+      *vertex++ = r * points[k];
+      *normal++ = points[k];
+      *texcoord++ = uvs[k];
+    }
+}
+
+/*! @addtogroup icosphere
+ * @{*/
+
+static inline size_t model_icosphere_nVertices (const unsigned int subdivisions)
+{
+  return (size_t) 60 << (2 * subdivisions);
+}
+
+/*!
+ * Every subdivision splits each triangle of the icosahedron in four, so each
+ * face becomes a grid of 2ˢ × 2ˢ triangles, projected onto the sphere.
+ */
+void model_icosphere_vertices (const float r,
+                               const unsigned int subdivisions,
+                               model_vector<vec3> &vertices,
+                               model_vector<vec3> &normals,
+                               model_vector<vec2> &texture,
+                               model_sink *const sink = nullptr)
+{
+  const float phi = (1 + sqrtf (5)) / 2;
+  const array<vec3, 12> corners{
+      vec3 (-1, phi, 0), vec3 (1, phi, 0), vec3 (-1, -phi, 0), vec3 (1, -phi, 0),
+      vec3 (0, -1, phi), vec3 (0, 1, phi), vec3 (0, -1, -phi), vec3 (0, 1, -phi),
+      vec3 (phi, 0, -1), vec3 (phi, 0, 1), vec3 (-phi, 0, -1), vec3 (-phi, 0, 1)
+  };
+  // counterclockwise seen from outside
+  const array<array<int, 3>, 20> faces{{
+      {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+      {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+      {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+      {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+  }};
+  const unsigned int n = 1u << subdivisions;
+
+  // a row per face
+  model_fill_rows (faces.size (), model_icosphere_nVertices (subdivisions) / faces.size (),
+                   vertices, normals, texture, sink,
+                   [&] (const size_t face, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    const vec3 a = corners[faces[face][0]];
+    const vec3 b = corners[faces[face][1]];
+    const vec3 c = corners[faces[face][2]];
+    // point (i, j) of the face's grid, i steps towards b and j towards c
+    const auto point = [&] (const unsigned int i, const unsigned int j) {
+      return normalize (a + (b - a) * ((float) i / (float) n) + (c - a) * ((float) j / (float) n));
+    };
+    for (unsigned int i = 0; i < n; ++i)
+      for (unsigned int j = 0; i + j < n; ++j)
+        {
+          model_sphere_triangle (r, {point (i, j), point (i + 1, j), point (i, j + 1)}, vertex, normal, texcoord);
+          if (i + j + 1 < n)
+            model_sphere_triangle (r, {point (i + 1, j), point (i + 1, j + 1), point (i, j + 1)},
+                                   vertex, normal, texcoord);
+        }
+  });
+}
+
+//!@} end of group icosphere
+
+/*! @addtogroup cubesphere
+ * @{*/
+
+static inline size_t model_cubesphere_nVertices (const unsigned int divisions)
+{
+  return (size_t) divisions * divisions * 36;
+}
+
+/*!
+ * Each face of the cube is a grid of divisions × divisions quads, projected
+ * onto the sphere. The grid is spaced evenly in angle rather than along the
+ * face, `tan(π/4 ⋅ a)` for a ∈ [-1, 1], which keeps the quads at the center
+ * of a face about as large as the ones at its corners. Quads are split along
+ * their shorter diagonal.
+ */
+void model_cubesphere_vertices (const float r,
+                                const unsigned int divisions,
+                                model_vector<vec3> &vertices,
+                                model_vector<vec3> &normals,
+                                model_vector<vec2> &texture,
+                                model_sink *const sink = nullptr)
+{
+  // the center of every face and its two axes, with cross (u, v) = center
+  const array<array<vec3, 3>, 6> faces{{
+      {vec3 (1, 0, 0), vec3 (0, 0, -1), vec3 (0, 1, 0)},
+      {vec3 (-1, 0, 0), vec3 (0, 0, 1), vec3 (0, 1, 0)},
+      {vec3 (0, 1, 0), vec3 (1, 0, 0), vec3 (0, 0, -1)},
+      {vec3 (0, -1, 0), vec3 (1, 0, 0), vec3 (0, 0, 1)},
+      {vec3 (0, 0, 1), vec3 (1, 0, 0), vec3 (0, 1, 0)},
+      {vec3 (0, 0, -1), vec3 (-1, 0, 0), vec3 (0, 1, 0)}
+  }};
+  vector<float> offsets (divisions + 1);
+  for (unsigned int k = 0; k <= divisions; ++k)
+    offsets[k] = tanf ((float) M_PI / 4 * (2 * (float) k / (float) divisions - 1));
+
+  // a row of quads per face and step along its u axis
+  model_fill_rows (6 * (size_t) divisions, 6 * (size_t) divisions, vertices, normals, texture, sink,
+                   [&] (const size_t row, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    const auto &[center, u, v] = faces[row / divisions];
+    const size_t i = row % divisions;
+    const auto point = [&] (const size_t ui, const size_t vi) {
+      return normalize (center + u * offsets[ui] + v * offsets[vi]);
+    };
+    for (unsigned int j = 0; j < divisions; ++j)
+      {
+        const vec3 p00 = point (i, j), p10 = point (i + 1, j);
+        const vec3 p01 = point (i, j + 1), p11 = point (i + 1, j + 1);
+        if (glm::distance (p00, p11) <= glm::distance (p10, p01))
+          {
+            model_sphere_triangle (r, {p00, p10, p11}, vertex, normal, texcoord);
+            model_sphere_triangle (r, {p00, p11, p01}, vertex, normal, texcoord);
+          }
+        else
+          {
+            model_sphere_triangle (r, {p00, p10, p01}, vertex, normal, texcoord);
+            model_sphere_triangle (r, {p10, p11, p01}, vertex, normal, texcoord);
+          }
+      }
+  });
+}
+
+//!@} end of group cubesphere
+
+//!@} end of group sphereMesh
+
+//!@} end of group model
+
+/*! @addtogroup bezier
+ * @{ */
+/*!
+ * Parses the next number of a text patch file, skipping the whitespace and
+ * commas before it.
+ */
+template<typename T>
+static bool patch_parse (const char *&cursor, const char *const end, T &value)
+{
+  while (cursor < end && (*cursor == ',' || isspace ((unsigned char) *cursor)))
+    ++cursor;
+  const auto [next, error] = std::from_chars (cursor, end, value);
+  cursor = next;
+  return error == std::errc ();
+}
+
+/*!
+ * Reads a text or binary patch file (see @ref patchFormat) into its control
+ * point indices, 16 per patch, and its control points. The file is mapped
+ * instead of read, and text is parsed in place with std::from_chars.
+ *
+ * @return false, after reporting why, if the file can not be read or is malformed.
+ */
+static bool patch_read (const char *const patch, vector<uint32_t> &indices, vector<vec3> &points)
+{
+  const int fd = open (patch, O_RDONLY);
+  struct stat status{};
+  if (fd < 0 || fstat (fd, &status) || status.st_size == 0)
+    {
+      cerr << "[generator] failed to read patch file " << patch << endl;
+      if (fd >= 0)
+        close (fd);
+      return false;
+    }
+  const auto size = (size_t) status.st_size;
+  void *const mapping = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    {
+      cerr << "[generator] failed to map patch file " << patch << endl;
+      return false;
+    }
+  const auto *const begin = (const char *) mapping;
+  const char *const end = begin + size;
+
+  patch_header header{};
+  if (size >= sizeof (header))
+    memcpy (&header, begin, sizeof (header));
+  if (header.magic == PATCH_MAGIC)
+    {
+      const size_t indices_size = 16 * sizeof (uint32_t) * header.nPatches;
+      if (header.version != PATCH_VERSION
+          || size != sizeof (header) + indices_size + sizeof (vec3) * header.nPoints)
+        {
+          cerr << "[generator] malformed binary patch file " << patch << endl;
+          munmap (mapping, size);
+          return false;
+        }
+      indices.resize (16 * (size_t) header.nPatches);
+      points.resize (header.nPoints);
+      memcpy (indices.data (), begin + sizeof (header), indices_size);
+      memcpy (points.data (), begin + sizeof (header) + indices_size, sizeof (vec3) * header.nPoints);
+    }
+  else
+    {
+      const char *cursor = begin;
+      bool parsed = patch_parse (cursor, end, header.nPatches);
+      indices.resize (16 * (size_t) header.nPatches);
+      for (auto &index : indices)
+        parsed = parsed && patch_parse (cursor, end, index);
+      parsed = parsed && patch_parse (cursor, end, header.nPoints);
+      points.resize (header.nPoints);
+      for (auto &point : points)
+        parsed = parsed && patch_parse (cursor, end, point.x)
+                 && patch_parse (cursor, end, point.y) && patch_parse (cursor, end, point.z);
+      if (!parsed)
+        {
+          cerr << "[generator] malformed patch file " << patch << " at byte " << cursor - begin << endl;
+          munmap (mapping, size);
+          return false;
+        }
+    }
+  munmap (mapping, size);
+
+  for (const auto index : indices)
+    if (index >= points.size ())
+      {
+        cerr << "[generator] control point " << index << " out of range in " << patch << endl;
+        return false;
+      }
+  return true;
+}
+
+/*!
+ * Checks that a patch file can be read and starts like a text or binary patch
+ * file (see @ref patchFormat), without reading the patches (see patch_read).
+ *
+ * @return false, after reporting why, if it does not.
+ */
+static bool patch_check (const char *const patch)
+{
+  const int fd = open (patch, O_RDONLY);
+  struct stat status{};
+  // the largest header, and more than a text file's ⟨nPatches⟩ and the whitespace around it
+  char begin[32];
+  ssize_t size = -1;
+  if (fd >= 0 && !fstat (fd, &status) && status.st_size > 0)
+    size = pread (fd, begin, sizeof (begin), 0);
+  if (fd >= 0)
+    close (fd);
+  if (size <= 0)
+    {
+      cerr << "[generator] failed to read patch file " << patch << endl;
+      return false;
+    }
+
+  patch_header header{};
+  if ((size_t) size >= sizeof (header))
+    memcpy (&header, begin, sizeof (header));
+  if (header.magic == PATCH_MAGIC)
+    {
+      if (header.version != PATCH_VERSION
+          || (size_t) status.st_size != sizeof (header) + 16 * sizeof (uint32_t) * header.nPatches
+                                        + sizeof (vec3) * header.nPoints)
+        {
+          cerr << "[generator] malformed binary patch file " << patch << endl;
+          return false;
+        }
+    }
+  else
+    {
+      const char *cursor = begin;
+      if (!patch_parse (cursor, begin + size, header.nPatches))
+        {
+          cerr << "[generator] malformed patch file " << patch << " at byte " << cursor - begin << endl;
+          return false;
+        }
+    }
+  return true;
+}
+
+//! Control points of every patch of a text or binary patch file (see @ref patchFormat).
+vector<array<vec3, 16>> read_Bezier (const char *const patch)
+{
+  vector<uint32_t> indices;
+  vector<vec3> points;
+  if (!patch_read (patch, indices, points))
+    exit (EXIT_FAILURE);
+
+  vector<array<vec3, 16>> pointsInPatches (indices.size () / 16);
+  for (size_t p = 0; p < pointsInPatches.size (); ++p)
+    for (int j = 0; j < 16; ++j)
+      pointsInPatches[p][j] = points[indices[16 * p + j]];
+  return pointsInPatches;
+}
+
+//! Converts a text or binary patch file to a binary one (see @ref patchFormat).
+void patch_convert (const char *const patch, const char *const out_file)
+{
+  vector<uint32_t> indices;
+  vector<vec3> points;
+  if (!patch_read (patch, indices, points))
+    exit (EXIT_FAILURE);
+
+  FILE *fp = fopen (out_file, "w");
+  if (!fp)
+    {
+      fprintf (stderr, "failed to open file: %s", out_file);
+      exit (1);
+    }
+  patch_header header{};
+  header.magic = PATCH_MAGIC;
+  header.version = PATCH_VERSION;
+  header.nPatches = indices.size () / 16;
+  header.nPoints = points.size ();
+  fwrite (&header, sizeof (header), 1, fp);
+  fwrite (indices.data (), sizeof (uint32_t), indices.size (), fp);
+  fwrite (points.data (), sizeof (vec3), points.size (), fp);
+  fclose (fp);
+
+  *globalLog << "[generator] Wrote " << header.nPatches << " patches and "
+       << header.nPoints << " control points to " << out_file << endl;
+}
+
+static inline size_t model_bezier_patch_nVertices (const unsigned int tesselation)
+{
+  return (size_t) tesselation * tesselation * 6;
+}
+
+static inline size_t model_bezier_surface_nVertices (
+    const size_t number_of_patches,
+    const unsigned int tesselation)
+{
+  return model_bezier_patch_nVertices (tesselation) * number_of_patches;
+}
+
+/*!
+ * Cubic Bernstein basis, and its derivative, sampled at every grid coordinate
+ * of a given tesselation level. It only depends on the tesselation, so it is
+ * computed once and shared by all patches.
+ */
+struct bezier_basis {
+  int tesselation;
+  //! t[k] = k / tesselation, k ∈ {0,...,tesselation}
+  vector<float> t;
+  //! B[k][i] = Bᵢ(t[k]), i ∈ {0,...,3}
+  vector<vec4> B;
+  //! dB[k][i] = Bᵢ'(t[k])
+  vector<vec4> dB;
+};
+
+bezier_basis get_bezier_basis (const int tesselation)
+{
+  bezier_basis basis;
+  basis.tesselation = tesselation;
+  const double step = 1.0 / tesselation;
+  for (int k = 0; k <= tesselation; ++k)
+    {
+      const double t = k * step;
+      const double s = 1 - t;
+      basis.t.push_back ((float) t);
+      basis.B.emplace_back (s * s * s, 3 * t * s * s, 3 * t * t * s, t * t * t);
+      basis.dB.emplace_back (-3 * s * s, 3 * s * s - 6 * t * s, 6 * t * s - 3 * t * t, 3 * t * t);
+    }
+  return basis;
+}
+
+/*!
+ * Tessellates one patch into model_bezier_patch_nVertices(tesselation) vertices.
+ *
+ * Every point of the (tesselation + 1)² grid is evaluated once, with the basis
+ * tables, and the triangles are then assembled from that grid.
+ *
+ * @param[out] vertices first of the patch's vertices, already allocated.
+ * @param[out] normals first of the patch's normals, already allocated.
+ * @param[out] texture first of the patch's texture coordinates, already allocated.
+ */
+void get_bezier_patch (
+    const array<vec3, 16> &control_points,
+    const bezier_basis &basis,
+    vec3 *vertices,
+    vec3 *normals,
+    vec2 *texture)
+{
+  const int tesselation = basis.tesselation;
+  const int side = tesselation + 1;
+
+  // P_j(u) = Σᵢ Bᵢ(u)⋅cp[4j+i] and its derivative, the four curves in u at every grid column
+  vector<array<vec3, 4>> Pu (side), dPu (side);
+  for (int u = 0; u < side; ++u)
+    for (int j = 0; j < 4; ++j)
+      {
+        const vec3 *const cp = &control_points[4 * j];
+        const vec4 &B = basis.B[u];
+        const vec4 &dB = basis.dB[u];
+        Pu[u][j] = B[0] * cp[0] + B[1] * cp[1] + B[2] * cp[2] + B[3] * cp[3];
+        dPu[u][j] = dB[0] * cp[0] + dB[1] * cp[1] + dB[2] * cp[2] + dB[3] * cp[3];
+      }
+
+  // P(u,v) = Σⱼ Bⱼ(v)⋅P_j(u)
+  vector<vec3> grid_vertices (side * side), grid_normals (side * side);
+  for (int v = 0; v < side; ++v)
+    {
+      const vec4 &B = basis.B[v];
+      const vec4 &dB = basis.dB[v];
+      for (int u = 0; u < side; ++u)
+        {
+          const array<vec3, 4> &P = Pu[u];
+          const array<vec3, 4> &dP = dPu[u];
+          const vec3 tangent_u = B[0] * dP[0] + B[1] * dP[1] + B[2] * dP[2] + B[3] * dP[3];
+          const vec3 tangent_v = dB[0] * P[0] + dB[1] * P[1] + dB[2] * P[2] + dB[3] * P[3];
+          grid_vertices[v * side + u] = B[0] * P[0] + B[1] * P[1] + B[2] * P[2] + B[3] * P[3];
+          grid_normals[v * side + u] = normalize (cross (tangent_u, tangent_v));
+        }
+    }
+
+  for (int v = 0; v < tesselation; ++v)
+    {
+      for (int u = 0; u < tesselation; ++u)
+        {
+          for (auto e : {
+              // upper triangle
+              array<int, 2>{0, 1},
+              array<int, 2>{0, 0},
+              array<int, 2>{1, 0},
+              // lower triangle
+              array<int, 2>{1, 0},
+              array<int, 2>{1, 1},
+              array<int, 2>{0, 1},
+          })
+            {
+              const int gu = u + e[0];
+              const int gv = v + e[1];
+              *vertices++ = grid_vertices[gv * side + gu];
+              *normals++ = grid_normals[gv * side + gu];
+              *texture++ = vec2 (-basis.t[gu], -basis.t[gv]);
+            }
+        }
+    }
+}
+
+/*!
+ * Patches are tessellated in parallel, each one a row of model_fill_rows, so the
+ * result does not depend on the number of threads.
+ *
+ * @param control_elements 4 vertices define a bezier curve and 4 bezier curves define a bezier patch.
+ *                         A set of bezier patches define a bezier surface.
+ *                         Therefore, each control element of a bezier surface requires 16 vertices.
+ */
+void get_bezier_surface (
+    const vector<array<vec3, 16>> &control_elements,
+    const int tesselation,
+    model_vector<vec3> &vertices,
+    model_vector<vec3> &normals,
+    model_vector<vec2> &texture,
+    model_sink *const sink = nullptr)
+{
+  const bezier_basis basis = get_bezier_basis (tesselation);
+  model_fill_rows (control_elements.size (), model_bezier_patch_nVertices (tesselation),
+                   vertices, normals, texture, sink,
+                   [&] (const size_t patch, vec3 *vertex, vec3 *normal, vec2 *texcoord) {
+    get_bezier_patch (control_elements[patch], basis, vertex, normal, texcoord);
+  });
+}
+
+//!@} end of group bezier
+
+/*! @addtogroup adaptiveBezier
+ * @{
+ * Curvature-adaptive tessellation. Every patch gets its own levels nu × nv, the
+ * fewest for which the bound on the distance between a bicubic patch and its
+ * triangulation on a uniform (u,v) grid,
+ *
+ * \f[ ε(nu, nv) = \frac{1}{8} \left( \frac{M_{uu}}{nu^2} + \frac{2 M_{uv}}{nu ⋅ nv} + \frac{M_{vv}}{nv^2} \right), \f]
+ *
+ * stays below the requested maximum error, where \f$M_{uu}, M_{uv}, M_{vv}\f$
+ * bound the second derivatives of the patch (see bezier_second_derivative_bounds).
+ *
+ * Every edge is split as finely as the finest patch along it and its points
+ * are evaluated from the edge's own control points in a canonical direction,
+ * so the patches sharing an edge share its vertices bit for bit and no cracks
+ * open. The strip between each edge and the inner grid of the patch is
+ * stitched with triangles no wider than a grid cell.
+ */
+
+//! Patches are never split further than this along either direction.
+const int BEZIER_MAX_LEVEL = 1024;
+
+/*!
+ * Bounds of |S_uu|, |S_uv| and |S_vv| over a patch S. The derivatives of a
+ * bicubic patch are convex combinations of the second differences of its
+ * control points, scaled by 6, 9 and 6.
+ */
+static vec3 bezier_second_derivative_bounds (const array<vec3, 16> &cp)
+{
+  float uu = 0, uv = 0, vv = 0;
+  for (int j = 0; j < 4; ++j)
+    for (int i = 0; i < 2; ++i)
+      {
+        uu = std::max (uu, glm::length (cp[4 * j + i] + cp[4 * j + i + 2] - 2.0f * cp[4 * j + i + 1]));
+        vv = std::max (vv, glm::length (cp[4 * i + j] + cp[4 * (i + 2) + j] - 2.0f * cp[4 * (i + 1) + j]));
+      }
+  for (int j = 0; j < 3; ++j)
+    for (int i = 0; i < 3; ++i)
+      uv = std::max (uv, glm::length (cp[4 * (j + 1) + i + 1] - cp[4 * (j + 1) + i] - cp[4 * j + i + 1] + cp[4 * j + i]));
+  return {6 * uu, 9 * uv, 6 * vv};
+}
+
+static float bezier_error_bound (const vec3 &M, const int nu, const int nv)
+{
+  const auto fu = (float) nu;
+  const auto fv = (float) nv;
+  return (M[0] / (fu * fu) + 2 * M[1] / (fu * fv) + M[2] / (fv * fv)) / 8;
+}
+
+struct bezier_patch_levels {
+  int nu, nv;
+  //! edges v = 0, u = 1, v = 1 and u = 0 of the patch, indices into bezier_adaptive::edges
+  array<size_t, 4> edge;
+  //! whether the patch runs along the edge against its canonical direction
+  array<bool, 4> reversed;
+  //! first vertex of the patch in the output, and its number of vertices
+  size_t first, nVertices;
+};
+
+struct bezier_adaptive {
+  vector<bezier_patch_levels> patches;
+  //! points of every edge, in its canonical direction
+  vector<vector<vec3>> edges;
+  size_t nVertices;
+};
+
+//! Control points of the edges v = 0, u = 1, v = 1 and u = 0, in the directions of u and v.
+const int BEZIER_EDGES[4][4] = {{0, 1, 2, 3}, {3, 7, 11, 15}, {12, 13, 14, 15}, {0, 4, 8, 12}};
+
+/*!
+ * Chooses the levels of every patch and edge for a maximum error, evaluates
+ * the edges' points and reports how many triangles are saved compared with the
+ * uniform tesselation that has the same error bound.
+ */
+bezier_adaptive get_bezier_adaptive (const vector<array<vec3, 16>> &control_elements, const float max_error)
+{
+  bezier_adaptive adaptive{};
+  adaptive.patches.resize (control_elements.size ());
+
+  // patch levels, greedily refining whichever direction lowers the bound the most
+  int uniform_level = 1;
+  float max_bound = 0;
+  for (size_t p = 0; p < control_elements.size (); ++p)
+    {
+      const vec3 M = bezier_second_derivative_bounds (control_elements[p]);
+      int nu = 1, nv = 1;
+      while (bezier_error_bound (M, nu, nv) > max_error && (nu < BEZIER_MAX_LEVEL || nv < BEZIER_MAX_LEVEL))
+        {
+          if (nv == BEZIER_MAX_LEVEL
+              || (nu < BEZIER_MAX_LEVEL && bezier_error_bound (M, nu + 1, nv) <= bezier_error_bound (M, nu, nv + 1)))
+            ++nu;
+          else
+            ++nv;
+        }
+      max_bound = std::max (max_bound, bezier_error_bound (M, nu, nv));
+      // an inner grid needs at least 2 × 2 cells
+      adaptive.patches[p].nu = std::max (nu, 2);
+      adaptive.patches[p].nv = std::max (nv, 2);
+
+      const int level = (int) ceilf (sqrtf ((M[0] + 2 * M[1] + M[2]) / (8 * max_error)));
+      uniform_level = std::max (uniform_level, std::min (level, BEZIER_MAX_LEVEL));
+    }
+
+  // edges, identified by their control points in canonical direction
+  std::map<array<float, 12>, size_t> edge_ids;
+  vector<array<vec3, 4>> edge_control_points;
+  vector<int> edge_levels;
+  for (size_t p = 0; p < control_elements.size (); ++p)
+    {
+      bezier_patch_levels &levels = adaptive.patches[p];
+      for (int k = 0; k < 4; ++k)
+        {
+          array<vec3, 4> Q;
+          array<float, 12> forward, backward;
+          for (int i = 0; i < 4; ++i)
+            {
+              Q[i] = control_elements[p][BEZIER_EDGES[k][i]];
+              for (int c = 0; c < 3; ++c)
+                {
+                  forward[3 * i + c] = Q[i][c];
+                  backward[3 * (3 - i) + c] = Q[i][c];
+                }
+            }
+          levels.reversed[k] = backward < forward;
+          if (levels.reversed[k])
+            Q = {Q[3], Q[2], Q[1], Q[0]};
+
+          const auto [it, inserted] = edge_ids.try_emplace (levels.reversed[k] ? backward : forward,
+                                                            edge_control_points.size ());
+          if (inserted)
+            {
+              edge_control_points.push_back (Q);
+              edge_levels.push_back (1);
+            }
+          levels.edge[k] = it->second;
+          edge_levels[it->second] = std::max (edge_levels[it->second], k % 2 ? levels.nv : levels.nu);
+        }
+    }
+
+  adaptive.edges.resize (edge_control_points.size ());
+  for (size_t e = 0; e < edge_control_points.size (); ++e)
+    {
+      const array<vec3, 4> &Q = edge_control_points[e];
+      for (int k = 0; k <= edge_levels[e]; ++k)
+        {
+          const double t = (double) k / edge_levels[e];
+          const double s = 1 - t;
+          const vec4 B (s * s * s, 3 * t * s * s, 3 * t * t * s, t * t * t);
+          adaptive.edges[e].push_back (B[0] * Q[0] + B[1] * Q[1] + B[2] * Q[2] + B[3] * Q[3]);
+        }
+    }
+
+  // inner grid cells plus, for each edge, a strip of (edge level + inner points - 1) triangles
+  for (auto &levels : adaptive.patches)
+    {
+      size_t nTriangles = 2 * (size_t) (levels.nu - 2) * (levels.nv - 2);
+      for (int k = 0; k < 4; ++k)
+        nTriangles += (adaptive.edges[levels.edge[k]].size () - 1) + (k % 2 ? levels.nv : levels.nu) - 2;
+      levels.first = adaptive.nVertices;
+      levels.nVertices = 3 * nTriangles;
+      adaptive.nVertices += levels.nVertices;
+    }
+
+  const size_t nTriangles = adaptive.nVertices / 3;
+  const size_t nUniformTriangles = 2 * (size_t) uniform_level * uniform_level * control_elements.size ();
+  *globalLog << "[generator] adaptive bezier: " << nTriangles << " triangles, error bound " << max_bound
+       << "; uniform tesselation " << uniform_level << " has " << nUniformTriangles
+       << " triangles for the same bound, " << (long long) nUniformTriangles - (long long) nTriangles
+       << " (" << 100.0 * (1.0 - (double) nTriangles / (double) nUniformTriangles) << "%) saved" << endl;
+  return adaptive;
+}
+
+struct bezier_point {
+  vec3 position;
+  vec3 normal;
+  vec2 texture;
+};
+
+//! Same evaluation as get_bezier_patch, at any (u,v).
+static bezier_point bezier_point_at (const array<vec3, 16> &control_points, const double u, const double v)
+{
+  const double su = 1 - u, sv = 1 - v;
+  const vec4 Bu (su * su * su, 3 * u * su * su, 3 * u * u * su, u * u * u);
+  const vec4 dBu (-3 * su * su, 3 * su * su - 6 * u * su, 6 * u * su - 3 * u * u, 3 * u * u);
+  const vec4 Bv (sv * sv * sv, 3 * v * sv * sv, 3 * v * v * sv, v * v * v);
+  const vec4 dBv (-3 * sv * sv, 3 * sv * sv - 6 * v * sv, 6 * v * sv - 3 * v * v, 3 * v * v);
+
+  array<vec3, 4> P, dP;
+  for (int j = 0; j < 4; ++j)
+    {
+      const vec3 *const cp = &control_points[4 * j];
+      P[j] = Bu[0] * cp[0] + Bu[1] * cp[1] + Bu[2] * cp[2] + Bu[3] * cp[3];
+      dP[j] = dBu[0] * cp[0] + dBu[1] * cp[1] + dBu[2] * cp[2] + dBu[3] * cp[3];
+    }
+  const vec3 tangent_u = Bv[0] * dP[0] + Bv[1] * dP[1] + Bv[2] * dP[2] + Bv[3] * dP[3];
+  const vec3 tangent_v = dBv[0] * P[0] + dBv[1] * P[1] + dBv[2] * P[2] + dBv[3] * P[3];
+  return {Bv[0] * P[0] + Bv[1] * P[1] + Bv[2] * P[2] + Bv[3] * P[3],
+          normalize (cross (tangent_u, tangent_v)),
+          vec2 (-(float) u, -(float) v)};
+}
+
+/*!
+ * Tessellates one patch into levels.nVertices vertices: its inner grid, and a
+ * strip between each edge and the grid's outer ring. The triangles are counter
+ * clockwise in (u,v), like get_bezier_patch's.
+ */
+void get_bezier_adaptive_patch (
+    const array<vec3, 16> &control_points,
+    const bezier_patch_levels &levels,
+    const bezier_adaptive &adaptive,
+    vec3 *vertices,
+    vec3 *normals,
+    vec2 *texture)
+{
+  const int nu = levels.nu;
+  const int nv = levels.nv;
+  const auto triangle = [&] (const bezier_point &a, const bezier_point &b, const bezier_point &c) {
+    for (const bezier_point *point : {&a, &b, &c})
+      {
+        *vertices++ = point->position;
+        *normals++ = point->normal;
+        *texture++ = point->texture;
+      }
+  };
+
+  // inner grid, points (i/nu, j/nv) with i ∈ {1,...,nu-1} and j ∈ {1,...,nv-1}
+  const int side = nu - 1;
+  vector<bezier_point> inner ((size_t) side * (nv - 1));
+  for (int j = 1; j < nv; ++j)
+    for (int i = 1; i < nu; ++i)
+      inner[(j - 1) * side + i - 1] = bezier_point_at (control_points, (double) i / nu, (double) j / nv);
+  const auto inner_at = [&] (const int i, const int j) -> const bezier_point & {
+    return inner[(j - 1) * side + i - 1];
+  };
+
+  for (int j = 1; j < nv - 1; ++j)
+    for (int i = 1; i < nu - 1; ++i)
+      {
+        triangle (inner_at (i, j + 1), inner_at (i, j), inner_at (i + 1, j));
+        triangle (inner_at (i + 1, j), inner_at (i + 1, j + 1), inner_at (i, j + 1));
+      }
+
+  for (int k = 0; k < 4; ++k)
+    {
+      // outer points along the edge, in the direction of u or v
+      const vector<vec3> &edge = adaptive.edges[levels.edge[k]];
+      const int e = (int) edge.size () - 1;
+      vector<bezier_point> outer (e + 1);
+      for (int a = 0; a <= e; ++a)
+        {
+          const double t = (double) a / e;
+          const double u = k == 1 ? 1 : k == 3 ? 0 : t;
+          const double v = k == 0 ? 0 : k == 2 ? 1 : t;
+          outer[a] = bezier_point_at (control_points, u, v);
+          outer[a].position = edge[levels.reversed[k] ? e - a : a];
+        }
+
+      // the grid's outer row or column next to the edge
+      const int n = k % 2 ? nv : nu;
+      vector<const bezier_point *> ring (n - 1);
+      for (int b = 0; b < n - 1; ++b)
+        ring[b] = k == 0 ? &inner_at (b + 1, 1)
+                  : k == 1 ? &inner_at (nu - 1, b + 1)
+                    : k == 2 ? &inner_at (b + 1, nv - 1)
+                      : &inner_at (1, b + 1);
+
+      // zip both, advancing along whichever has the nearest next point;
+      // strips v = 1 and u = 0 run clockwise in (u,v), so their triangles are flipped
+      const bool flip = k >= 2;
+      const int m = n - 1;
+      for (int a = 0, b = 0; a < e || b < m - 1;)
+        {
+          const bool advance_outer = b == m - 1 || (a < e && (long) (a + 1) * n <= (long) (b + 2) * e);
+          const bezier_point &p = outer[a];
+          const bezier_point &q = advance_outer ? outer[a + 1] : *ring[b + 1];
+          const bezier_point &r = *ring[b];
+          if (flip)
+            triangle (p, r, q);
+          else
+            triangle (p, q, r);
+          if (advance_outer)
+            ++a;
+          else
+            ++b;
+        }
+    }
+}
+
+/*!
+ * Same as get_bezier_surface, with the levels chosen by get_bezier_adaptive.
+ */
+void get_bezier_adaptive_surface (
+    const vector<array<vec3, 16>> &control_elements,
+    const bezier_adaptive &adaptive,
+    model_vector<vec3> &vertices,
+    model_vector<vec3> &normals,
+    model_vector<vec2> &texture,
+    model_sink *const sink = nullptr)
+{
+  const size_t nPatches = control_elements.size ();
+  for (size_t first_patch = 0, last_patch; first_patch < nPatches; first_patch = last_patch)
+    {
+      // with a sink, patches are taken until a chunk is full
+      const size_t first_vertex = adaptive.patches[first_patch].first;
+      last_patch = sink ? first_patch + 1 : nPatches;
+      while (last_patch < nPatches && adaptive.patches[last_patch].first - first_vertex < sink->chunkVertices)
+        ++last_patch;
+
+      const size_t offset = vertices.size ();
+      const size_t nVertices = offset + (last_patch < nPatches ? adaptive.patches[last_patch].first : adaptive.nVertices)
+                               - first_vertex;
+      vertices.resize (nVertices);
+      normals.resize (nVertices);
+      texture.resize (nVertices);
+
+      parallel_for (last_patch - first_patch, [&] (const size_t patch) {
+        const bezier_patch_levels &levels = adaptive.patches[first_patch + patch];
+        const size_t first = offset + levels.first - first_vertex;
+        get_bezier_adaptive_patch (control_elements[first_patch + patch], levels, adaptive,
+                                   &vertices[first], &normals[first], &texture[first]);
+      });
+      model_sink_flush (sink, vertices, normals, texture);
+    }
+  model_sink_flush (sink, vertices, normals, texture, true);
+}
+
+//!@} end of group adaptiveBezier
+
+//! Announces the model's size to the sink or, without one, makes room for the whole model.
+static void model_prepare (const size_t nModelVertices,
+                           model_vector<vec3> &vertices,
+                           model_vector<vec3> &normals,
+                           model_vector<vec2> &texture,
+                           model_sink *const sink)
+{
+  if (sink)
+    {
+      sink->begin (nModelVertices);
+      return;
+    }
+  const size_t nVertices = vertices.size () + nModelVertices;
+  vertices.reserve (nVertices);
+  normals.reserve (nVertices);
+  texture.reserve (nVertices);
+}
+
+//! The integer an argument starts with, false if it does not start with one.
+bool model_int_argument (const char *const argument, int &value)
+{
+  char *end;
+  errno = 0;
+  const long parsed = strtol (argument, &end, 10);
+  value = (int) parsed;
+  return end != argument && !errno && parsed >= INT_MIN && parsed <= INT_MAX;
+}
+
+/*!
+ * Checks a ⟨model⟩ without its ⟨out_file⟩ (see generate_model) before it is
+ * built. Of its patch file, if any, only the start is checked (see
+ * patch_check), patches are read once, as the model is built.
+ *
+ * @return false, after reporting why, if generate_model could not build it.
+ */
+bool model_check (const int argc, const char *const argv[])
+{
+  if (argc < 4)
+    {
+      cerr << "[generator] Not enough arguments" << endl;
+      return false;
+    }
+  const char *const polygon = argv[1];
+  // each argument, checked in order, is valid unless a check failed before it
+  bool valid = true;
+  const auto positive = [&] (const int a, const char *const what) {
+    if (valid && !(strtof (argv[a], nullptr) > 0))
+      {
+        cerr << "[generator] invalid " << what << "(" << argv[a] << ") for " << polygon << endl;
+        valid = false;
+      }
+  };
+  const auto integer = [&] (const int a, const char *const what, const int min, const int max) {
+    int value;
+    if (valid && (!model_int_argument (argv[a], value) || value < min || value > max))
+      {
+        cerr << "[generator] invalid " << what << "(" << argv[a] << ") for " << polygon << endl;
+        valid = false;
+      }
+  };
+  const auto patch = [&] (const int a) {
+    if (valid && !patch_check (argv[a]))
+      valid = false;
+  };
+  const auto enough = [&] (const int needed) {
+    if (argc < needed)
+      {
+        cerr << "[generator] Not enough arguments for " << polygon << endl;
+        valid = false;
+      }
+  };
+
+  if (!strcmp (PLANE, polygon) || !strcmp (CUBE, polygon))
+    {
+      positive (2, "length");
+      integer (3, "number of divisions", 1, INT_MAX);
+    }
+  else if (!strcmp (CONE, polygon))
+    {
+      enough (6);
+      positive (2, "radius");
+      positive (3, "height");
+      integer (4, "slices", 1, INT_MAX);
+      integer (5, "stacks", 1, INT_MAX);
+    }
+  else if (!strcmp (SPHERE, polygon))
+    {
+      enough (5);
+      positive (2, "radius");
+      integer (3, "slices", 1, INT_MAX);
+      integer (4, "stacks", 1, INT_MAX);
+    }
+  else if (!strcmp (ICOSPHERE, polygon))
+    {
+      positive (2, "radius");
+      integer (3, "subdivisions", 0, 12);
+    }
+  else if (!strcmp (CUBESPHERE, polygon))
+    {
+      positive (2, "radius");
+      integer (3, "number of divisions", 1, INT_MAX);
+    }
+  else if (!strcmp (BEZIER, polygon))
+    {
+      integer (3, "tesselation", 1, INT_MAX);
+      patch (2);
+    }
+  else if (!strcmp (BEZIER_ADAPTIVE, polygon))
+    {
+      positive (3, "maximum error");
+      patch (2);
+    }
+  else
+    {
+      cerr << "[generator] Unkown object type: " << polygon << endl;
+      valid = false;
+    }
+  return valid;
+}
+
+/*!
+ * Builds the unindexed triangle list of a ⟨model⟩ without its ⟨out_file⟩
+ * (see the generator's main), argv[0] is ignored. The triangles are appended
+ * to vertices, normals and texture or, with a sink, handed to it in chunks.
+ * Exits if the ⟨model⟩ is invalid (see model_check).
+ */
+void generate_model (const int argc,
+                     const char *const argv[],
+                     model_vector<vec3> &vertices,
+                     model_vector<vec3> &normals,
+                     model_vector<vec2> &texture,
+                     model_sink *const sink)
+{
+  if (!model_check (argc, argv))
+    exit (EXIT_FAILURE);
+
+  const char *const polygon = argv[1];
+  *globalLog << "[generator] polygon to generate: " << polygon << endl;
+
+  if (!strcmp (PLANE, polygon))
+    {
+      const float length = strtof (argv[2], nullptr);
+      const int divisions = std::stoi (argv[3], nullptr, 10);
+      *globalLog << "[generator] PLANE(length: " << length << ", divisions: " << divisions << ")" << endl;
+      model_prepare (model_plane_nVertices (divisions), vertices, normals, texture, sink);
+      model_plane_vertices (length, divisions, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (CUBE, polygon))
+    {
+      const float length = strtof (argv[2], nullptr);
+      const int divisions = std::stoi (argv[3], nullptr, 10);
+      *globalLog << "[generator] CUBE(length: " << length << ", divisions: " << divisions << ")" << endl;
+      model_prepare (model_cube_nVertices (divisions), vertices, normals, texture, sink);
+      model_cube_vertices (length, divisions, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (CONE, polygon))
+    {
+      const float radius = strtof (argv[2], nullptr);
+      const float height = strtof (argv[3], nullptr);
+      const int slices = std::stoi (argv[4], nullptr, 10);
+      const int stacks = std::stoi (argv[5], nullptr, 10);
+      *globalLog << "[generator] CONE(radius: " << radius
+           << ", height: " << height
+           << ", slices: " << slices
+           << ", stacks: " << stacks << ")" << endl;
+      model_prepare (model_cone_nVertices (stacks, slices), vertices, normals, texture, sink);
+      model_cone_vertices (radius, height, slices, stacks, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (SPHERE, polygon))
+    {
+      const float radius = strtof (argv[2], nullptr);
+      const int slices = std::stoi (argv[3], nullptr, 10);
+      const int stacks = std::stoi (argv[4], nullptr, 10);
+      *globalLog << "[generator] SPHERE(radius: " << radius
+           << ", slices: " << slices
+           << ", stacks: " << stacks << ")"
+           << endl;
+      model_prepare (model_sphere_nVertices (slices, stacks), vertices, normals, texture, sink);
+      model_sphere_vertices (radius, slices, stacks, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (ICOSPHERE, polygon))
+    {
+      const float radius = strtof (argv[2], nullptr);
+      const int subdivisions = std::stoi (argv[3], nullptr, 10);
+      *globalLog << "[generator] ICOSPHERE(radius: " << radius
+           << ", subdivisions: " << subdivisions << ")" << endl;
+      model_prepare (model_icosphere_nVertices (subdivisions), vertices, normals, texture, sink);
+      model_icosphere_vertices (radius, subdivisions, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (CUBESPHERE, polygon))
+    {
+      const float radius = strtof (argv[2], nullptr);
+      const int divisions = std::stoi (argv[3], nullptr, 10);
+      *globalLog << "[generator] CUBESPHERE(radius: " << radius
+           << ", divisions: " << divisions << ")" << endl;
+      model_prepare (model_cubesphere_nVertices (divisions), vertices, normals, texture, sink);
+      model_cubesphere_vertices (radius, divisions, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (BEZIER, polygon))
+    {
+      const int tesselation = std::stoi (argv[3], nullptr, 10);
+      const char *const input_patch_file_path = argv[2];
+      *globalLog << "BEZIER(tesselation: " << tesselation << ", input file: " << input_patch_file_path << ")" << endl;
+      const vector<array<vec3, 16>> control_points = read_Bezier (input_patch_file_path);
+      model_prepare (model_bezier_surface_nVertices (control_points.size (), tesselation),
+                     vertices, normals, texture, sink);
+      get_bezier_surface (control_points, tesselation, vertices, normals, texture, sink);
+    }
+  else if (!strcmp (BEZIER_ADAPTIVE, polygon))
+    {
+      const float max_error = strtof (argv[3], nullptr);
+      const char *const input_patch_file_path = argv[2];
+      *globalLog << "BEZIER_ADAPTIVE(max error: " << max_error << ", input file: " << input_patch_file_path << ")" << endl;
+      const vector<array<vec3, 16>> control_points = read_Bezier (input_patch_file_path);
+      const bezier_adaptive adaptive = get_bezier_adaptive (control_points, max_error);
+      model_prepare (adaptive.nVertices, vertices, normals, texture, sink);
+      get_bezier_adaptive_surface (control_points, adaptive, vertices, normals, texture, sink);
+    }
+}
+
+//!@} end of group generator
@@ -0,0 +1,150 @@
+#ifndef PROJ_PRIMITIVES_H
+#define PROJ_PRIMITIVES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iosfwd>
+#include <array>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "model.h"
+
+/*! @addtogroup generator
+ * @{
+ * The primitives are built by a library shared by the generator and the
+ * engine, so the engine can build a model in memory instead of running the
+ * generator and reading back its .3d file.
+ */
+
+//! Worker threads used by parallel_for, 0 means one per hardware thread (see `--threads`).
+extern unsigned int globalThreads;
+
+//! Stream this thread reports what it builds and writes to, errors always go to cerr (see generate_batch).
+extern thread_local std::ostream *globalLog;
+
+/*!
+ * Allocator of the streams of a model, which leaves the elements resize() adds
+ * uninitialised. Builders size the streams once and fill them in parallel (see
+ * model_fill_rows), so each page is first written by the thread that fills it
+ * instead of being zeroed up front by a single one.
+ */
+template<typename T>
+struct model_allocator : std::allocator<T> {
+  model_allocator () = default;
+  template<typename U> model_allocator (const model_allocator<U> &) noexcept {}
+  template<typename U> struct rebind {
+    using other = model_allocator<U>;
+  };
+
+  //! default-initialises, which leaves trivial elements, such as glm's vectors, unset
+  template<typename U> void construct (U *const p) noexcept
+  { ::new ((void *) p) U; }
+  template<typename U, typename... Args> void construct (U *const p, Args &&... args)
+  { ::new ((void *) p) U (std::forward<Args> (args)...); }
+};
+
+//! The positions, normals or texture coordinates of a model.
+template<typename T> using model_vector = std::vector<T, model_allocator<T>>;
+
+void parallel_for (size_t n, const std::function<void (size_t)> &body);
+void parallel_for_serial ();
+
+//! Vertices a model_stream_write chunk holds, 2 MiB of positions, normals and texture coordinates.
+const size_t MODEL_STREAM_CHUNK = 1 << 16;
+
+/*!
+ * Takes the triangles of a model while they are being built, so that only a
+ * chunk of them is ever kept in memory (see model_stream_write).
+ */
+struct model_sink {
+  //! vertices to accumulate before each call to write
+  size_t chunkVertices;
+  //! called once, with the total number of vertices of the model, before any chunk
+  std::function<void (uint64_t nVertices)> begin;
+  //! called with each chunk, a whole number of triangles, in order
+  std::function<void (const model_vector<glm::vec3> &vertices,
+                      const model_vector<glm::vec3> &normals,
+                      const model_vector<glm::vec2> &texture)> write;
+};
+
+bool model_int_argument (const char *argument, int &value);
+bool model_check (int argc, const char *const argv[]);
+
+void generate_model (int argc,
+                     const char *const argv[],
+                     model_vector<glm::vec3> &vertices,
+                     model_vector<glm::vec3> &normals,
+                     model_vector<glm::vec2> &texture,
+                     model_sink *sink = nullptr);
+
+//! Control points of every patch of a patch file, 16 per patch.
+std::vector<std::array<glm::vec3, 16>> read_Bezier (const char *patch);
+
+void patch_convert (const char *patch, const char *out_file);
+
+void model_weld (model_vector<glm::vec3> &vertices,
+                 model_vector<glm::vec3> &normals,
+                 model_vector<glm::vec2> &texture,
+                 std::vector<uint32_t> &indices);
+
+//! Welded models are reordered by model_optimize before being written (see `--optimize`).
+extern bool globalOptimize;
+
+void model_optimize (model_vector<glm::vec3> &vertices,
+                     model_vector<glm::vec3> &normals,
+                     model_vector<glm::vec2> &texture,
+                     std::vector<uint32_t> &indices);
+
+/*!
+ * Bounds of nVertices positions, the first three floats of every stride floats,
+ * the sphere centered at the center of the box.
+ */
+model_bounds model_compute_bounds (const float *positions, size_t nVertices, size_t stride = 3);
+
+void model_write (const char *filename,
+                  model_vector<glm::vec3> &vertices,
+                  model_vector<glm::vec3> &normals,
+                  model_vector<glm::vec2> &texture,
+                  bool interleaved = false);
+
+void model_quantized_write (const char *filename,
+                            model_vector<glm::vec3> &vertices,
+                            model_vector<glm::vec3> &normals,
+                            model_vector<glm::vec2> &texture,
+                            bool quantize_positions);
+
+void model_cluster_write (const char *filename,
+                          model_vector<glm::vec3> &vertices,
+                          model_vector<glm::vec3> &normals,
+                          model_vector<glm::vec2> &texture);
+
+void model_sections_write (const char *filename,
+                           model_vector<glm::vec3> &vertices,
+                           model_vector<glm::vec3> &normals,
+                           model_vector<glm::vec2> &texture,
+                           bool interleaved,
+                           bool clustered);
+
+void model_stream_write (const char *filename, int argc, const char *const argv[]);
+
+void model_lod_write (const char *filename, int argc, const char *const argv[], int nLevels);
+
+void model_read (const char *filename,
+                 model_vector<glm::vec3> &vertices,
+                 model_vector<glm::vec3> &normals,
+                 model_vector<glm::vec2> &texture);
+
+float model_simplify (model_vector<glm::vec3> &vertices,
+                      model_vector<glm::vec3> &normals,
+                      model_vector<glm::vec2> &texture,
+                      float target_ratio,
+                      float max_error);
+
+//! @} end of group generator
+#endif //PROJ_PRIMITIVES_H
@@ -0,0 +1,133 @@
+#include <cstring>
+#include <cstdlib>
+
+#include <IL/il.h>
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <filesystem>
+
+#include "tinyxml2.h"
+#include "parsing.h"
+#include "texture_cache.h"
+
+using std::vector, std::string;
+using std::cerr, std::endl;
+using tinyxml2::XMLDocument, tinyxml2::XMLElement;
+
+/*! @defgroup texcache Texture cache prewarming
+ * @{
+ * Fills the texture cache (see @ref textureCache) with the textures of worlds,
+ * or with images, so that even the engine's first start maps them:
+ * @code{.unparsed}
+ * texcache test_4_solar_system.xml earth_8k.jpg
+ * @endcode
+ * Textures are found like the engine finds them, relative to the working
+ * directory, so worlds are prewarmed from their directory. The cache settings
+ * of a world (`<textures cache="..." cacheMaxMB="..."/>`) apply from that world on.
+ */
+
+static unsigned int globalCached = 0;
+static unsigned int globalUpToDate = 0;
+
+//! Decodes an image to RGBA, bottom row first, and stores it with its mip chain, unless it is already cached.
+static void texcache_image (const string &path)
+{
+  if (!std::filesystem::is_regular_file (path))
+    {
+      cerr << "[texcache] " << path << " not found" << endl;
+      exit (EXIT_FAILURE);
+    }
+  uint64_t hash;
+  const string entry = texture_cache_entry (path, hash);
+  if (entry.empty ())
+    {
+      cerr << "[texcache] no cache directory, it is disabled or neither XDG_CACHE_HOME nor HOME is set" << endl;
+      exit (EXIT_FAILURE);
+    }
+  texture_cache_header header{};
+  size_t size;
+  if (const unsigned char *const mapping = texture_cache_map (entry, hash, header, size))
+    {
+      texture_cache_unmap (mapping, size);
+      ++globalUpToDate;
+      return;
+    }
+
+  static bool isFirstTimeBeingExecuted = true;
+  if (isFirstTimeBeingExecuted)
+    {
+      ilInit ();
+      ilEnable (IL_ORIGIN_SET);
+      ilOriginFunc (IL_ORIGIN_LOWER_LEFT);
+      isFirstTimeBeingExecuted = false;
+    }
+
+  ILuint image;
+  ilGenImages (1, &image);
+  ilBindImage (image);
+  if (!ilLoadImage ((ILstring) path.c_str ()) || !ilConvertImage (IL_RGBA, IL_UNSIGNED_BYTE))
+    {
+      cerr << "[texcache] failed decoding texture " << path << "\nERROR#" << ilGetError () << endl;
+      exit (EXIT_FAILURE);
+    }
+  const auto width = (uint32_t) ilGetInteger (IL_IMAGE_WIDTH);
+  const auto height = (uint32_t) ilGetInteger (IL_IMAGE_HEIGHT);
+  const auto *const rgba = (const unsigned char *) ilGetData ();
+  texture_cache_store (entry, hash, width, height, rgba, texture_mip_chain (width, height, rgba));
+  ilDeleteImages (1, &image);
+  cerr << "[texcache] " << path << " (" << width << "x" << height << ") -> " << entry << endl;
+  ++globalCached;
+}
+
+//! Prewarms the texture of every model under an element.
+static void texcache_world (const XMLElement &element)
+{
+  for (const XMLElement *child = element.FirstChildElement (); child; child = child->NextSiblingElement ())
+    {
+      if (!strcmp (child->Value (), "texture"))
+        {
+          if (const char *const file = child->Attribute ("file"))
+            texcache_image (file);
+        }
+      else
+        texcache_world (*child);
+    }
+}
+
+/*!
+ * ⟨command⟩ ::= "texcache" (⟨xml_file⟩ | ⟨image_file⟩)⁺
+ */
+int main (int argc, const char *const argv[])
+{
+  if (argc < 2)
+    {
+      cerr << "[texcache] usage: texcache (<xml_file> | <image_file>)..." << endl;
+      exit (EXIT_FAILURE);
+    }
+
+  for (int a = 1; a < argc; ++a)
+    {
+      if (std::filesystem::path (argv[a]).extension () != ".xml")
+        {
+          texcache_image (argv[a]);
+          continue;
+        }
+      XMLDocument doc;
+      if (doc.LoadFile (argv[a]))
+        {
+          cerr << "[texcache] failed loading " << argv[a] << ": " << doc.ErrorName () << endl;
+          exit (EXIT_FAILURE);
+        }
+      if (const XMLElement *const world = doc.FirstChildElement ("world"))
+        {
+          texture_cache_configure (*world);
+          texcache_world (*world);
+        }
+    }
+  cerr << "[texcache] " << globalCached << " textures cached, " << globalUpToDate << " already up to date" << endl;
+  return 0;
+}
+
+//! @} end of group texcache
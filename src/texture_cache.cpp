@@ -0,0 +1,228 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <filesystem>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "parsing.h"
+#include "texture_cache.h"
+
+using std::vector, std::string;
+using std::cerr, std::endl;
+
+/*! @addtogroup textureCache
+ * @{
+ */
+
+/*!
+ * Number of levels of a full mip chain of an image, the image included.
+ * @param mips_size set to the bytes of the levels after the first.
+ */
+static uint32_t texture_levels (uint32_t width, uint32_t height, size_t &mips_size)
+{
+  uint32_t nLevels = 1;
+  mips_size = 0;
+  while (width > 1 || height > 1)
+    {
+      width = std::max (1u, width / 2);
+      height = std::max (1u, height / 2);
+      mips_size += 4 * (size_t) width * height;
+      ++nLevels;
+    }
+  return nLevels;
+}
+
+/*!
+ * @param source_hash set to the hash of the image file.
+ * @return path of the cache entry of an image, empty when caching is disabled.
+ */
+string texture_cache_entry (const string &image_path, uint64_t &source_hash)
+{
+  source_hash = fnv1a_file (image_path);
+  if (globalTextureCacheDir.empty ())
+    return "";
+  char name[32];
+  snprintf (name, sizeof (name), "%016llx.rgba", (unsigned long long) source_hash);
+  return globalTextureCacheDir + "/" + name;
+}
+
+/*!
+ * Every level after the first of an RGBA image's mip chain, one after the
+ * other, each pixel the average of the 2x2 pixels of the level before.
+ */
+vector<unsigned char> texture_mip_chain (uint32_t width, uint32_t height, const unsigned char *rgba)
+{
+  size_t mips_size;
+  texture_levels (width, height, mips_size);
+  vector<unsigned char> mips (mips_size);
+  unsigned char *level = mips.data ();
+  while (width > 1 || height > 1)
+    {
+      const uint32_t level_width = std::max (1u, width / 2);
+      const uint32_t level_height = std::max (1u, height / 2);
+      for (uint32_t y = 0; y < level_height; ++y)
+        for (uint32_t x = 0; x < level_width; ++x)
+          {
+            // an odd last row or column is averaged with itself
+            const size_t x0 = 2 * x, x1 = std::min (2 * x + 1, width - 1);
+            const size_t y0 = 2 * y, y1 = std::min (2 * y + 1, height - 1);
+            for (int c = 0; c < 4; ++c)
+              level[4 * (y * (size_t) level_width + x) + c] = (unsigned char) (
+                  (rgba[4 * (y0 * width + x0) + c] + rgba[4 * (y0 * width + x1) + c]
+                   + rgba[4 * (y1 * width + x0) + c] + rgba[4 * (y1 * width + x1) + c] + 2) / 4);
+          }
+      rgba = level;
+      level += 4 * (size_t) level_width * level_height;
+      width = level_width;
+      height = level_height;
+    }
+  return mips;
+}
+
+/*!
+ * Maps a cache entry read only.
+ * @return the mapping, header first, or nullptr when the entry is missing or
+ * was not decoded from the image of source_hash by this version.
+ */
+const unsigned char *texture_cache_map (const string &entry, const uint64_t source_hash,
+                                        texture_cache_header &header, size_t &size)
+{
+  const int fd = open (entry.c_str (), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+  struct stat entryStat{};
+  void *mapping = MAP_FAILED;
+  if (!fstat (fd, &entryStat) && (size_t) entryStat.st_size >= sizeof (header))
+    mapping = mmap (nullptr, entryStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    return nullptr;
+  size = entryStat.st_size;
+
+  memcpy (&header, mapping, sizeof (header));
+  size_t mips_size;
+  if (header.magic != TEXTURE_CACHE_MAGIC || header.version != TEXTURE_CACHE_VERSION
+      || header.sourceHash != source_hash || header.width == 0 || header.height == 0
+      || header.nLevels != texture_levels (header.width, header.height, mips_size)
+      || size != sizeof (header) + 4 * (size_t) header.width * header.height + mips_size)
+    {
+      munmap (mapping, size);
+      return nullptr;
+    }
+  // the modification time orders entries for pruning, failing to update it only makes the entry older
+  std::error_code error;
+  std::filesystem::last_write_time (entry, std::filesystem::file_time_type::clock::now (), error);
+  return (const unsigned char *) mapping;
+}
+
+void texture_cache_unmap (const unsigned char *const mapping, const size_t size)
+{
+  if (mapping)
+    munmap ((void *) mapping, size);
+}
+
+/*!
+ * Removes the least recently used entries while the cache is above
+ * globalTextureCacheMaxBytes, if it is not 0.
+ * @return the number of entries removed.
+ */
+unsigned int texture_cache_prune ()
+{
+  namespace fs = std::filesystem;
+  if (globalTextureCacheDir.empty () || !globalTextureCacheMaxBytes)
+    return 0;
+  // loader threads store concurrently, one of them prunes at a time
+  static std::mutex mutex;
+  const std::lock_guard<std::mutex> lock (mutex);
+
+  // a cache entry, with what pruning needs to know of it
+  struct cached {
+    fs::path path;
+    std::uintmax_t size;
+    fs::file_time_type time;
+  };
+  vector<cached> entries;
+  std::uintmax_t size = 0;
+  std::error_code error;
+  for (fs::directory_iterator entry (globalTextureCacheDir, error), end; !error && entry != end; entry.increment (error))
+    {
+      // entries that vanish or can not be read are left alone
+      std::error_code entry_error;
+      if (entry->path ().extension () != ".rgba" || !entry->is_regular_file (entry_error))
+        continue;
+      cached cached_entry{entry->path (), entry->file_size (entry_error), {}};
+      if (!entry_error)
+        cached_entry.time = entry->last_write_time (entry_error);
+      if (entry_error)
+        continue;
+      entries.push_back (cached_entry);
+      size += cached_entry.size;
+    }
+
+  std::sort (entries.begin (), entries.end (), [] (const cached &a, const cached &b) { return a.time < b.time; });
+  unsigned int pruned = 0;
+  for (auto entry = entries.begin (); size > globalTextureCacheMaxBytes && entry != entries.end (); ++entry)
+    if (fs::remove (entry->path, error))
+      {
+        size -= entry->size;
+        ++pruned;
+      }
+  return pruned;
+}
+
+/*!
+ * Writes a cache entry, under a temporary name first so no reader sees it
+ * partially written, then prunes the cache. Failing to is only reported, the
+ * texture is still used.
+ */
+void texture_cache_store (const string &entry, const uint64_t source_hash, const uint32_t width,
+                          const uint32_t height, const unsigned char *const rgba, const vector<unsigned char> &mips)
+{
+  static std::atomic<unsigned int> nStored = 0;
+  const string temporary = entry + "." + std::to_string (getpid ()) + "." + std::to_string (nStored++) + ".tmp";
+  std::error_code error;
+  std::filesystem::create_directories (std::filesystem::path (entry).parent_path (), error);
+
+  texture_cache_header header{};
+  header.magic = TEXTURE_CACHE_MAGIC;
+  header.version = TEXTURE_CACHE_VERSION;
+  header.width = width;
+  header.height = height;
+  size_t mips_size;
+  header.nLevels = texture_levels (width, height, mips_size);
+  header.sourceHash = source_hash;
+
+  const size_t rgba_size = 4 * (size_t) width * height;
+  FILE *fp = fopen (temporary.c_str (), "wb");
+  bool written = fp && fwrite (&header, sizeof (header), 1, fp) == 1 && fwrite (rgba, 1, rgba_size, fp) == rgba_size
+                 && fwrite (mips.data (), 1, mips.size (), fp) == mips.size ();
+  if (fp && fclose (fp))
+    written = false;
+  if (!written)
+    {
+      cerr << "[texture_cache] failed writing " << entry << endl;
+      std::filesystem::remove (temporary, error);
+      return;
+    }
+  std::filesystem::rename (temporary, entry, error);
+  if (error)
+    {
+      cerr << "[texture_cache] failed storing " << entry << ": " << error.message () << endl;
+      std::filesystem::remove (temporary, error);
+      return;
+    }
+  texture_cache_prune ();
+}
+
+//! @} end of group textureCache
@@ -0,0 +1,59 @@
+#ifndef PROJ_TEXTURE_CACHE_H
+#define PROJ_TEXTURE_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*! @addtogroup textureCache
+ * @{
+ * # Texture cache
+ *
+ * Images are decoded once: every texture the engine decodes is kept, as RGBA
+ * with its whole mip chain, in a cache entry named after the hash of the image
+ * file. The engine maps the entry and uploads its levels instead of decoding
+ * the image and generating its mipmaps again.
+ * @code{.unparsed}
+ * ⟨entry⟩ ::= ⟨texture_cache_header⟩ ⟨level⟩ⁿ
+ *      n ::= texture_cache_header::nLevels
+ *      ⟨level⟩ ::= ⟨rgba8⟩ʷʰ   (w and h halved, down to 1, from one level to the next)
+ * @endcode
+ * Levels are bottom row first, as the engine uploads them. The cache is at
+ * $XDG_CACHE_HOME/solar-system/textures (or ~/.cache/solar-system/textures),
+ * a world can move it, or disable it with `cache=""`, and limit its size, in
+ * which case the least recently used entries are removed after every store:
+ * @code{.xml}
+ * <textures cache="path/to/cache" cacheMaxMB="2048"/>
+ * @endcode
+ * `texcache` fills it ahead of time, with the settings of the worlds it is given:
+ * @code{.unparsed}
+ * texcache test_4_solar_system.xml
+ * @endcode
+ */
+
+const int32_t TEXTURE_CACHE_MAGIC = -0x7ec;
+const uint32_t TEXTURE_CACHE_VERSION = 1;
+
+struct texture_cache_header {
+  int32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t nLevels;
+  uint32_t reserved;
+  //! hash of the image file the entry was decoded from
+  uint64_t sourceHash;
+};
+
+std::string texture_cache_entry (const std::string &image_path, uint64_t &source_hash);
+std::vector<unsigned char> texture_mip_chain (uint32_t width, uint32_t height, const unsigned char *rgba);
+const unsigned char *texture_cache_map (const std::string &entry, uint64_t source_hash,
+                                        texture_cache_header &header, size_t &size);
+void texture_cache_unmap (const unsigned char *mapping, size_t size);
+unsigned int texture_cache_prune ();
+void texture_cache_store (const std::string &entry, uint64_t source_hash, uint32_t width, uint32_t height,
+                          const unsigned char *rgba, const std::vector<unsigned char> &mips);
+
+//! @} end of group textureCache
+#endif //PROJ_TEXTURE_CACHE_H